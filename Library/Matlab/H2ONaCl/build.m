@@ -14,6 +14,18 @@ mex lutGen_3D.cpp -I'../../../include' -L'../../../lib' -leosH2ONaCl; %exit;
 mex lutInfo.cpp -I'../../../include' -L'../../../lib' -leosH2ONaCl; %exit;
 
 % 4.1 build lookupLUT_2D
+% parallel version if you have OpenMP
+% mex lutLookup_2D.cpp -DUSE_OMP=1 -I'../../../include' -I'/usr/local/include' -L'../../../lib' -leosH2ONaCl_par -L'/usr/local/lib' -lomp; %exit;
+% serial version
 mex lutLookup_2D.cpp -I'../../../include' -L'../../../lib' -leosH2ONaCl; %exit;
 % 4.2 build lookupLUT_3D
+% parallel version if you have OpenMP
+% mex lutLookup_3D.cpp -DUSE_OMP=1 -I'../../../include' -I'/usr/local/include' -L'../../../lib' -leosH2ONaCl_par -L'/usr/local/lib' -lomp; %exit;
+% serial version
 mex lutLookup_3D.cpp -I'../../../include' -L'../../../lib' -leosH2ONaCl; %exit;
+
+% 5. build eosProp
+% parallel version if you have OpenMP
+% mex eosProp.cpp -DUSE_OMP=1 -I'../../../include' -I'/usr/local/include' -L'../../../lib' -leosH2ONaCl_par -L'/usr/local/lib' -lomp; %exit;
+% serial version
+mex eosProp.cpp -I'../../../include' -L'../../../lib' -leosH2ONaCl; %exit;
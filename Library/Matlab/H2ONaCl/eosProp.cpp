@@ -0,0 +1,59 @@
+#include "mex.h"
+#include <matrix.h>
+#include <math.h>
+#include <string.h>
+#include <iostream>
+#include <vector>
+#include <climits>
+using namespace std;
+#include "H2ONaCl.H"
+
+// Calculate the properties of the points (P, T/H, X) by prop_pTX or prop_pHX, the points are calculated in parallel if the MEX file is compiled with OpenMP.
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    // check arguments
+    if(nrhs<4 || nrhs>5){
+    mexErrMsgTxt("Usage: props = eosProp(P, TorH, X, TorH_type, num_threads=1)\nTorH_type: 0 means T[K], 1 means H[J/kg]; P[Pa], X[wt. NaCl, 0~1]");
+    }
+    if(nlhs>1)mexErrMsgTxt("Too many output arguments, the output is a struct of the properties.");
+    const char* names[3] = {"P", "TorH", "X"};
+    mwSize m = mxGetM(prhs[0]), n = mxGetN(prhs[0]);
+    for (int i = 0; i < 3; i++)
+    {
+        if(!mxIsDouble(prhs[i]) || mxIsComplex(prhs[i]))mexErrMsgTxt((string("'")+names[i]+"' must be of type 'double'.").c_str());
+        if(mxGetM(prhs[i]) != m || mxGetN(prhs[i]) != n)mexErrMsgTxt("The sizes of P, TorH and X must be the same.");
+    }
+    if((double)m*n > INT_MAX)mexErrMsgTxt("Too many points, split the points in several calls.");
+    const int num_points = (int)(m*n);
+    int TorH_type = (int)mxGetScalar(prhs[3]);
+    if(TorH_type != LOOKUPTABLE_FOREST::EOS_ENERGY_T && TorH_type != LOOKUPTABLE_FOREST::EOS_ENERGY_H)mexErrMsgTxt("TorH_type must be 0 (T) or 1 (H).");
+    int num_threads = nrhs==5 ? (int)mxGetScalar(prhs[4]) : 1;
+
+    H2ONaCl::cH2ONaCl sw;
+  #if USE_OMP == 1
+    sw.set_num_threads(num_threads < 1 ? 1: num_threads);
+  #else
+    if(num_threads > 1)mexWarnMsgTxt("The MEX file is not compiled with OpenMP (-DUSE_OMP=1), num_threads is ignored.");
+  #endif
+    // output struct, one field per column of H2ONaCl::PROP_COLUMN and the phase region
+    vector<string> fieldnames(H2ONaCl::NUM_PROP_COLUMNS);
+    vector<const char*> pFieldnames(H2ONaCl::NUM_PROP_COLUMNS + 1);
+    for (int j = 0; j < H2ONaCl::NUM_PROP_COLUMNS; j++)
+    {
+        fieldnames[j] = sw.getPropColumnName(j);
+        pFieldnames[j] = fieldnames[j].c_str();
+    }
+    pFieldnames[H2ONaCl::NUM_PROP_COLUMNS] = "Region";
+    plhs[0] = mxCreateStructMatrix(1, 1, H2ONaCl::NUM_PROP_COLUMNS + 1, pFieldnames.data());
+    vector<double*> columns(H2ONaCl::NUM_PROP_COLUMNS);
+    for (int j = 0; j < H2ONaCl::NUM_PROP_COLUMNS; j++)
+    {
+        mxArray* column = mxCreateDoubleMatrix(m, n, mxREAL);
+        columns[j] = mxGetPr(column);
+        mxSetFieldByNumber(plhs[0], 0, j, column);
+    }
+    mxArray* region = mxCreateNumericMatrix(m, n, mxINT32_CLASS, mxREAL);
+    mxSetFieldByNumber(plhs[0], 0, H2ONaCl::NUM_PROP_COLUMNS, region);
+
+    sw.prop_columns(num_points, mxGetPr(prhs[0]), mxGetPr(prhs[1]), mxGetPr(prhs[2]), (LOOKUPTABLE_FOREST::EOS_ENERGY)TorH_type, columns.data(), (H2ONaCl::PhaseRegion*)mxGetData(region));
+}
@@ -0,0 +1,12 @@
+% eosProp.m Help file for eosProp MEX file
+%
+% Calculate the properties of H2O-NaCl at the points (P, T/H, X) by the EOS, without a LUT.
+%   props = eosProp(P, TorH, X, TorH_type, num_threads=1);
+%   * P, TorH and X are arrays of the same size, the fields of props have the same size.
+%   * TorH_type: 0 means TorH is temperature, the properties are calculated by prop_pTX; 1 means TorH is enthalpy, by prop_pHX.
+%   * Input unit: T[K], P[Pa], X[wt. NaCl, 0~1], H[J/kg]
+%   * props is a struct with the fields T, P, X_wt, H, Cp, Rho, Mu, Rho_l, Rho_v, Rho_h, H_l, H_v, H_h, Cp_l, Cp_v, Cp_h,
+%     S_l, S_v, S_h, X_l, X_v, Mu_l, Mu_v, dRhodH and Region (int32 phase region). Note that T of the output is in deg.C.
+%   * num_threads = 1, can be set to other int value for parallel computing if the mex file is compiled with OpenMP
+%
+%   MEX File function.
@@ -0,0 +1,219 @@
+// Shared implementation of the lutLookup_2D and lutLookup_3D MEX functions.
+//
+// A MEX file stays loaded in MATLAB between calls, so the LUTs are kept in a map keyed by filename and reused by the following calls
+// instead of reading the binary file again. A LUT is reloaded if its file is modified, e.g. rewritten by lutGen_2D/lutGen_3D.
+// Each MEX file has its own cache, it is released by the 'clear' command of the MEX function, by "clear mex" or when MATLAB exits.
+//
+// Note that the library calls exit() on errors, which closes MATLAB, so the arguments are checked here before calling the library.
+
+#ifndef LUTLOOKUP_H
+#define LUTLOOKUP_H
+
+#include "mex.h"
+#include <matrix.h>
+#include <math.h>
+#include <string.h>
+#include <iostream>
+#include <map>
+#include <sys/stat.h>
+#include <chrono>
+#include <climits>
+using namespace std;
+#include "H2ONaCl.H"
+
+static void mGetMatrix(const mxArray *prhs, double **out, const char *varname, mwSize *out_m, mwSize *out_n)
+{
+  mwSize m, n;
+  double *temp;
+
+  m = mxGetM(prhs);
+  n = mxGetN(prhs);
+
+  if(!mxIsDouble(prhs) || mxIsComplex(prhs)){
+    char buff[256];
+    sprintf(buff, "'%s' must be of type 'double'.\n", varname);
+    mexErrMsgTxt(buff);
+  }
+
+  temp   = (double*)mxGetData(prhs);
+  *out   = temp;
+  *out_m = m;
+  *out_n = n;
+}
+
+struct CachedLUT
+{
+    H2ONaCl::cH2ONaCl* sw;
+    time_t mtime; /**< Modification time of the file when it was loaded */
+    off_t size;   /**< Size of the file when it was loaded */
+};
+
+static std::map<string, CachedLUT> g_cached_luts;
+
+static void clear_cached_luts()
+{
+    for (auto &m : g_cached_luts)delete m.second.sw;
+    g_cached_luts.clear();
+}
+
+/**
+ * @brief Handle the 'clear' command: fun('clear') releases all the cached LUTs, fun('clear', filename) releases the LUT of filename.
+ *
+ * @return true if the arguments are a 'clear' command
+ */
+static bool clear_command(int nrhs, const mxArray *prhs[])
+{
+    if(nrhs < 1 || nrhs > 2 || !mxIsChar(prhs[0]))return false;
+    char* cmd = mxArrayToString(prhs[0]);
+    bool isClear = strcmp(cmd, "clear") == 0;
+    mxFree(cmd);
+    if(!isClear || (nrhs == 2 && !mxIsChar(prhs[1])))return false;
+    if(nrhs == 1)
+    {
+        clear_cached_luts();
+    }else
+    {
+        char* filename = mxArrayToString(prhs[1]);
+        std::map<string, CachedLUT>::iterator it = g_cached_luts.find(filename);
+        mxFree(filename);
+        if(it != g_cached_luts.end())
+        {
+            delete it->second.sw;
+            g_cached_luts.erase(it);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Get the LUT of filename from the cache, load it if it is not cached or the file has been modified since it was loaded.
+ *
+ * @param dim Required dim of the LUT
+ */
+static H2ONaCl::cH2ONaCl* get_cached_lut(string filename, int dim)
+{
+    mexAtExit(clear_cached_luts);
+    struct stat info;
+    if(stat(filename.c_str(), &info) != 0)mexErrMsgTxt(("Open file failed: "+filename).c_str());
+    std::map<string, CachedLUT>::iterator it = g_cached_luts.find(filename);
+    if(it != g_cached_luts.end())
+    {
+        if(it->second.mtime == info.st_mtime && it->second.size == info.st_size)return it->second.sw;
+        delete it->second.sw;
+        g_cached_luts.erase(it);
+    }
+    if(LOOKUPTABLE_FOREST::get_dim_from_binary(filename) != dim)mexErrMsgTxt(("The input LUT file is not "+to_string(dim)+"D: "+filename).c_str());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    H2ONaCl::cH2ONaCl* sw = new H2ONaCl::cH2ONaCl;
+    sw->loadLUT(filename);
+    STATUS("Load LUT end: "+filename+", time: "+to_string(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count())+" s");
+    CachedLUT lut = {sw, info.st_mtime, info.st_size};
+    g_cached_luts[filename] = lut;
+    return sw;
+}
+
+/**
+ * @brief Find the index of a property in the data array of a LUT, the properties are ordered by the key of m_map_props.
+ */
+static int get_prop_index(std::map<int, propInfo>& map_props, int which_prop, string name, string filename)
+{
+    std::map<int, propInfo>::iterator it = map_props.find(which_prop);
+    if(it == map_props.end())mexErrMsgTxt(("The LUT does not include the property "+name+": "+filename).c_str());
+    return distance(map_props.begin(), it);
+}
+
+/**
+ * @brief Set the number of threads of the following calculation, it is the optional last argument of the MEX functions.
+ */
+static void set_num_threads(H2ONaCl::cH2ONaCl* sw, const mxArray* arg)
+{
+    int num_threads = (int)mxGetScalar(arg);
+  #if USE_OMP == 1
+    sw->set_num_threads(num_threads < 1 ? 1 : num_threads);
+  #else
+    if(num_threads > 1)mexWarnMsgTxt("The MEX file is not compiled with OpenMP (-DUSE_OMP=1), num_threads is ignored.");
+  #endif
+}
+
+/**
+ * @brief [needRefine, rho, T, phaseRegion] = lutLookup_<dim>D(filename, x, y[, z], num_threads)
+ *
+ * The points are looked up by cH2ONaCl::lookup_batch_deferred and the points in the leaves which need refine are calculated by the EOS (cal_deferred),
+ * both are parallelized by OpenMP if the library is compiled with OpenMP.
+ */
+template <int dim>
+void lutLookup(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[], const char* usage)
+{
+    if(clear_command(nrhs, prhs))return;
+    if(nrhs < dim + 1 || nrhs > dim + 2 || !mxIsChar(prhs[0]))mexErrMsgTxt(usage);
+    if(nlhs > 4)mexErrMsgTxt("Too many output arguments, the outputs are [needRefine, rho, T, phaseRegion].");
+    /* input variables */
+    const char* names[3] = {"x", "y", "z"};
+    double *xyz[3] = {NULL, NULL, NULL};
+    mwSize m, n, m_d, n_d;
+    char* str = mxArrayToString(prhs[0]);
+    string filename(str);
+    mxFree(str);
+    for (int d = 0; d < dim; d++)
+    {
+        mGetMatrix(prhs[d + 1], &xyz[d], names[d], &m_d, &n_d);
+        if(d == 0)
+        {
+            m = m_d; n = n_d;
+        }else if(m_d != m || n_d != n)
+        {
+            mexErrMsgTxt("The sizes of x, y and z must be the same.");
+        }
+    }
+    if((double)m*n > INT_MAX)mexErrMsgTxt("Too many points, split the points in several calls.");
+    const int num_points = (int)(m*n);
+
+    H2ONaCl::cH2ONaCl* sw = get_cached_lut(filename, dim);
+    if(nrhs == dim + 2)set_num_threads(sw, prhs[dim + 1]);
+    LOOKUPTABLE_FOREST::LookUpTableForest<dim,H2ONaCl::FIELD_DATA<dim> >* pLUT = (LOOKUPTABLE_FOREST::LookUpTableForest<dim,H2ONaCl::FIELD_DATA<dim> >*)sw->m_pLUT;
+    // ====== get order of props in the data array =====
+    int index_Rho = get_prop_index(pLUT->m_map_props, Update_prop_rho, "Rho", filename);
+    int index_T = get_prop_index(pLUT->m_map_props, Update_prop_T, "T", filename);
+    // =================================================
+    // safety check before calling the library: bound check
+    for (int d = 0; d < dim; d++)
+    {
+        for (int i = 0; i < num_points; i++)
+        {
+            if(!(xyz[d][i] >= pLUT->m_xyz_min[d] && xyz[d][i] <= pLUT->m_xyz_max[d]))
+            {
+                char buff[256];
+                snprintf(buff, sizeof(buff), "The lookup point %d: %s = %g is out of the LUT range [%g, %g].", i + 1, names[d], xyz[d][i], pLUT->m_xyz_min[d], pLUT->m_xyz_max[d]);
+                mexErrMsgTxt(buff);
+            }
+        }
+    }
+
+    /* output variables, rho and T are written by the lookup directly, the other properties of the LUT to a scratch buffer */
+    plhs[0] = mxCreateNumericMatrix(m, n, mxINT32_CLASS, mxREAL);
+    LOOKUPTABLE_FOREST::NeedRefine *needRefine_out = (LOOKUPTABLE_FOREST::NeedRefine*)mxGetData(plhs[0]);
+    mxArray* Rho = mxCreateDoubleMatrix(m, n, mxREAL);
+    mxArray* T = mxCreateDoubleMatrix(m, n, mxREAL);
+    mxArray* phaseRegion = mxCreateNumericMatrix(m, n, mxINT32_CLASS, mxREAL);
+    const int num_props = (int)pLUT->m_map_props.size();
+    vector<double> props_other((size_t)max(num_props - 2, 0)*num_points);
+    vector<double*> props(num_props);
+    for (int j = 0, k = 0; j < num_props; j++)
+    {
+        if(j == index_Rho)props[j] = mxGetPr(Rho);
+        else if(j == index_T)props[j] = mxGetPr(T);
+        else props[j] = props_other.data() + (size_t)(k++)*num_points;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<int> index_refine;
+    int num_refine = sw->lookup_batch_deferred(num_points, xyz[0], xyz[1], xyz[2], props.data(), index_refine, (H2ONaCl::PhaseRegion*)mxGetData(phaseRegion), needRefine_out);
+    sw->cal_deferred(index_refine, xyz[0], xyz[1], xyz[2], props.data());
+    STATUS("Lookup end, "+to_string(num_refine)+" of "+to_string(num_points)+" points calculated by EOS, time: "+to_string(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count())+" s");
+
+    if(nlhs > 1)plhs[1] = Rho; else mxDestroyArray(Rho);
+    if(nlhs > 2)plhs[2] = T; else mxDestroyArray(T);
+    if(nlhs > 3)plhs[3] = phaseRegion; else mxDestroyArray(phaseRegion);
+}
+
+#endif
@@ -1,8 +1,15 @@
 % lutLookup_2D.m Help file for lutLookup_2D MEX file
 %
-% look up a point (x,y) in a 2D LUT.
-%   lutLookup_2D(filename, x, y);
+% look up points (x,y) in a 2D LUT.
+%   [needRefine, rho, T, phaseRegion] = lutLookup_2D(filename, x, y, num_threads=1);
 %   Note that the x, y MUST BE consistent with x/y definition in the LUT file. You could use lutInfo.m to check this information.
 %   Unit: T[K], H[J/kg], P[Pa], X[wt.NaCl 0~1]
+%   * x and y are arrays of the same size, the outputs have the same size.
+%   * The points in the cells which need refine are calculated by the EOS instead of interpolation.
+%   * The LUT is loaded by the first call and kept in memory for the following calls with the same filename,
+%     it is loaded again if the file is modified.
+%     -- lutLookup_2D('clear') releases all the LUTs in memory
+%     -- lutLookup_2D('clear', filename) releases the LUT of filename
+%   * num_threads = 1, can be set to other int value for parallel computing if the mex file is compiled with OpenMP
 %
-%   MEX File function.
\ No newline at end of file
+%   MEX File function.
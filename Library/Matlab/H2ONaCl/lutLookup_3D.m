@@ -1,7 +1,14 @@
 % lutLookup_3D.m Help file for lutLookup_3D MEX file
 %
-% look up a point (x,y,z) in a 3D LUT.
-%   lutLookup_3D(filename, x, y,z);
+% look up points (x,y,z) in a 3D LUT.
+%   [needRefine, rho, T, phaseRegion] = lutLookup_3D(filename, x, y, z, num_threads=1);
 %   Note that the x, y, z order MUST BE T/H, P, X. Unit is : T[K], H[J/kg], P[Pa], X[wt.NaCl 0~1]
+%   * x, y and z are arrays of the same size, the outputs have the same size.
+%   * The points in the cells which need refine are calculated by the EOS instead of interpolation.
+%   * The LUT is loaded by the first call and kept in memory for the following calls with the same filename,
+%     it is loaded again if the file is modified.
+%     -- lutLookup_3D('clear') releases all the LUTs in memory
+%     -- lutLookup_3D('clear', filename) releases the LUT of filename
+%   * num_threads = 1, can be set to other int value for parallel computing if the mex file is compiled with OpenMP
 %
-%   MEX File function.
\ No newline at end of file
+%   MEX File function.
@@ -4,6 +4,8 @@
 % [needRefine, rho, T] = test_lookupLUT_2D_random();
 % test_createLUT_2D();
 % test_createLUT_3D();
+% test_lookupLUT_timesteps();
+% props = test_eosProp();
 
 function [needRefine, rho, T] = test_lookupLUT_3D()
     p0 = 200E5;
@@ -74,5 +76,25 @@ function test_createLUT_2D()
     lutGen_2D(Xmin, Xmax, Hmin, Hmax, 350E5, 2, TorH, 'lut_constP_XH', min_level, max_level, num_threads)
 end
 
+function test_lookupLUT_timesteps()
+    % the LUT is loaded by the first call only, the following time steps use the LUT in memory
+    num_threads = 8;
+    for step = 1:10
+        X = rand(1000).*(1-0.001) + 0.001;
+        H = (rand(1000).*(3.5-0.1) + 0.1).*1E6;
+        [needRefine, rho, T, phaseRegion] = lutLookup_2D('lut_constP_XH_8.bin', X, H, num_threads);
+    end
+    % release the LUT
+    lutLookup_2D('clear');
+end
 
-
+function props = test_eosProp()
+    num_threads = 8;
+    x=linspace(0.001, 1, 100);
+    h=linspace(0.1, 3.5, 100)*1E6;
+    [X,H]=meshgrid(x,h);
+    P = H.*0 + 350E5;
+    TorH = 1; % 0 means TPX space; 1 means HPX space
+    props = eosProp(P, H, X, TorH, num_threads);
+    contourf(X,H,props.Rho);
+end
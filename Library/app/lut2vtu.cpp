@@ -2,10 +2,26 @@
 
 int main(int argc, char** argv)
 {
-    if(argc!=2)ERROR("Usage: lutinfo myLUT.bin");
+    if(argc<2 || argc>5)ERROR("Usage: lut2vtu myLUT.bin [ascii|raw|base64] [zlib] [number of pieces]");
+    LOOKUPTABLE_FOREST::VTU_FORMAT format = LOOKUPTABLE_FOREST::VTU_FORMAT_RAW;
+    bool compress = false, isLegacy = true; //without format options, the LUT is written by the ASCII writer as before
+    int num_pieces = 0;
+    for (int i = 2; i < argc; i++)
+    {
+        string arg(argv[i]);
+        isLegacy = false;
+        if(arg == "ascii")format = LOOKUPTABLE_FOREST::VTU_FORMAT_ASCII;
+        else if(arg == "raw")format = LOOKUPTABLE_FOREST::VTU_FORMAT_RAW;
+        else if(arg == "base64")format = LOOKUPTABLE_FOREST::VTU_FORMAT_BASE64;
+        else if(arg == "zlib")compress = true;
+        else if(atoi(argv[i]) > 0)num_pieces = atoi(argv[i]);
+        else ERROR("Unknown argument: "+arg+"\nUsage: lut2vtu myLUT.bin [ascii|raw|base64] [zlib] [number of pieces]");
+    }
     H2ONaCl::cH2ONaCl sw;
     sw.loadLUT(argv[1]);
     // sw.save_lut_to_binary(string(argv[1])+".bin");
-    sw.save_lut_to_vtk(string(argv[1])+".vtu");
+    if(num_pieces > 0)sw.save_lut_to_pvtu(string(argv[1])+".pvtu", num_pieces, format, compress);
+    else if(isLegacy)sw.save_lut_to_vtk(string(argv[1])+".vtu");
+    else sw.save_lut_to_vtu(string(argv[1])+".vtu", format, compress);
     return 0;
 }
\ No newline at end of file
@@ -2,7 +2,7 @@
 
 int main(int argc, char** argv)
 {
-    if(argc!=2)ERROR("Usage: lutinfo myLUT.bin");
+    if(argc<2 || argc>3 || (argc==3 && string(argv[2])!="verify"))ERROR("Usage: lutinfo myLUT.bin [verify]\n   verify: verify the checksums of all data of a single-file LUT");
     // H2ONaCl::cH2ONaCl sw;
     // sw.loadLUT(argv[1]);
     int m_dim_lut = LOOKUPTABLE_FOREST::get_dim_from_binary(argv[1]);
@@ -23,5 +23,10 @@ int main(int argc, char** argv)
         ERROR("The dim in the binary file is neither 2 nor 3, it is not a valid LUT file: "+string(argv[1]));
         break;
     }
+    if(argc==3)
+    {
+        if(!LOOKUPTABLE_FOREST::verify_single_binary(argv[1]))ERROR("Verification failed: "+string(argv[1]));
+        STATUS("All checksums are correct: "+string(argv[1]));
+    }
     return 0;
 }
\ No newline at end of file
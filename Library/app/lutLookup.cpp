@@ -1,114 +1,249 @@
+// Look up the properties of a list of points in a LUT.
+//
+// Input points are (x, y, z) triples, z is ignored by a 2D LUT:
+//   - text file: one point per line, separated by spaces, e.g. the Random.xyz of lutRandom
+//   - binary file (*.bin): 3 doubles per point, memory-mapped if possible
+// Output (the format is chosen by the extension, *.bin is binary, otherwise text):
+//   - text file: header line, then phase region, need-refine and the properties of each point, separated by tabs
+//   - binary file: uint64 number of points, uint64 number of properties, then one record per point:
+//     int32 phase region, int32 need-refine, double properties[number of properties], the properties are in the order of the header of the text output
+// The points are processed in chunks, so the memory does not depend on the number of points.
+// Properties of the points in the leaves which need refine are calculated by the EOS after the interpolation of a chunk, see cH2ONaCl::lookup_batch_deferred.
+
 #include "H2ONaCl.H"
 
+bool is_binary_file(string filename)
+{
+    return filename.size() > 4 && filename.substr(filename.size() - 4) == ".bin";
+}
+
+/**
+ * @brief Map a whole file to memory, return NULL if the platform does not support it or the file is empty.
+ *
+ */
+char* map_file(FILE* fp, size_t length, bool writable)
+{
+#ifndef _WIN32
+    if(length == 0)return NULL;
+    void* addr = mmap(NULL, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fileno(fp), 0);
+    if(addr == MAP_FAILED)return NULL;
+    if(!writable)madvise(addr, length, MADV_SEQUENTIAL);
+    return (char*)addr;
+#else
+    return NULL;
+#endif
+}
+void unmap_file(char* addr, size_t length)
+{
+#ifndef _WIN32
+    if(addr)munmap(addr, length);
+#endif
+}
+
+size_t read_text_points(FILE* fp, size_t num_points, double* x, double* y, double* z)
+{
+    char line[1024];
+    size_t n = 0;
+    while (n < num_points && fgets(line, sizeof(line), fp))
+    {
+        char* p = line;
+        char* p_end = NULL;
+        double xyz[3];
+        int i = 0;
+        for (; i < 3; i++, p = p_end)
+        {
+            xyz[i] = strtod(p, &p_end);
+            if(p_end == p)break;
+        }
+        if(i == 0)continue; //empty line
+        if(i < 3)ERROR("Each line of the input file must have three values: x y z, the line is: "+string(line));
+        x[n] = xyz[0];
+        y[n] = xyz[1];
+        z[n] = xyz[2];
+        n++;
+    }
+    return n;
+}
+
 int main(int argc, char** argv)
 {
-    if(argc!=3)ERROR("Usage: lutLookup myLUT.bin xyz.txt");
+    if(argc<3 || argc>5)ERROR("Usage: lutLookup myLUT.bin xyz.txt|xyz.bin [lookup_result.csv|lookup_result.bin] [points per chunk]");
+    string filename_in(argv[2]);
+    string filename_out = argc > 3 ? string(argv[3]) : (is_binary_file(filename_in) ? "lookup_result.bin" : "lookup_result.csv");
+    size_t size_chunk = argc > 4 ? atol(argv[4]) : (1<<20);
+    if(size_chunk == 0)ERROR("The number of points per chunk must be positive");
+    bool isBinaryIn = is_binary_file(filename_in), isBinaryOut = is_binary_file(filename_out);
 
     // 1. load lut
     H2ONaCl::cH2ONaCl sw;
     sw.loadLUT(argv[1]);
-    // 2. read xyz 
-    STATUS("Reading xyz data ...");
-    vector<double> x, y, z;
-    double tmp_x, tmp_y, tmp_z;
-    ifstream fin(argv[2]);
-    if(!fin)ERROR("Open file failed: "+string(argv[2]));
-    while (!fin.eof())
+    if(sw.m_dim_lut != 2 && sw.m_dim_lut != 3)ERROR("The dim of the LUT must be 2 or 3: "+string(argv[1]));
+    std::map<int, propInfo>& map_props = sw.m_dim_lut == 2 ? ((H2ONaCl::LookUpTableForest_2D*)sw.m_pLUT)->m_map_props : ((H2ONaCl::LookUpTableForest_3D*)sw.m_pLUT)->m_map_props;
+    const size_t num_props = map_props.size();
+
+    // 2. open input and output
+    FILE* fpin = fopen(filename_in.c_str(), isBinaryIn ? "rb" : "r");
+    if(!fpin)ERROR("Open file failed: "+filename_in);
+    size_t num_points = 0; //only known for binary input
+    const double* xyz_mapped = NULL;
+    size_t length_in = 0;
+    if(isBinaryIn)
+    {
+        fseek(fpin, 0, SEEK_END);
+        length_in = ftell(fpin);
+        fseek(fpin, 0, SEEK_SET);
+        if(length_in % (3*sizeof(double)) != 0)ERROR("Size of the binary input file is not a multiple of 3 doubles: "+filename_in);
+        num_points = length_in/(3*sizeof(double));
+        xyz_mapped = (const double*)map_file(fpin, length_in, false);
+    }
+    FILE* fpout = fopen(filename_out.c_str(), isBinaryOut ? (isBinaryIn ? "w+b" : "wb") : "w");
+    if(!fpout)ERROR("Open file failed: "+filename_out);
+    const size_t size_header = 2*sizeof(unsigned long long);
+    const size_t size_record = 2*sizeof(int) + num_props*sizeof(double);
+    char* records_mapped = NULL;
+    size_t length_out = 0;
+    if(isBinaryOut)
     {
-        fin>>tmp_x>>tmp_y>>tmp_z;
-        x.push_back(tmp_x);
-        y.push_back(tmp_y);
-        z.push_back(tmp_z);
+        unsigned long long header[2] = {num_points, num_props};
+        fwrite(header, sizeof(unsigned long long), 2, fpout);
+        // the output of a binary input has a known size, so it can be mapped and written by all threads
+        if(isBinaryIn)
+        {
+            length_out = size_header + num_points*size_record;
+            fflush(fpout);
+#ifndef _WIN32
+            if(ftruncate(fileno(fpout), length_out) == 0)records_mapped = map_file(fpout, length_out, true);
+#endif
+        }
+    }else
+    {
+        fprintf(fpout, "Phase region\tNeed_refine");
+        for (auto &m : map_props)fprintf(fpout, "\t%s", m.second.longName);
+        fprintf(fpout, "\n");
     }
-    fin.close();
-    // 3. lookup
-    STATUS("Start looking up ... ");
-    H2ONaCl::PROP_H2ONaCl prop_lookup;
-    vector<H2ONaCl::PhaseRegion> pb_lookup(x.size(), H2ONaCl::SinglePhase_L);
-    int ind = 0;
-    time_t start = clock();
-    switch (sw.m_dim_lut)
+    STATUS("Looking up "+(isBinaryIn ? to_string(num_points)+" points of " : string("points of "))+filename_in+(xyz_mapped ? " (memory-mapped)" : "")
+           +" in chunks of "+to_string(size_chunk)+" points, results are written to "+filename_out+(records_mapped ? " (memory-mapped)" : ""));
+
+    // 3. lookup chunk by chunk
+    vector<double> x(size_chunk), y(size_chunk), z(size_chunk), buffer_in;
+    vector<vector<double> > props(num_props, vector<double>(size_chunk));
+    vector<double*> pProps(num_props);
+    for (size_t j = 0; j < num_props; j++)pProps[j] = props[j].data();
+    vector<H2ONaCl::PhaseRegion> phaseRegion(size_chunk);
+    vector<LOOKUPTABLE_FOREST::NeedRefine> need_refine(size_chunk);
+    vector<int> index_refine;
+    vector<char> buffer_out;
+    const int size_block_text = 4096; //points formatted by one thread
+    vector<string> text_blocks((size_chunk + size_block_text - 1)/size_block_text);
+    double time_read = 0, time_lookup = 0, time_write = 0;
+    size_t num_done = 0, num_mix = 0, num_refine = 0;
+    std::chrono::steady_clock::time_point start_all = std::chrono::steady_clock::now();
+    while (true)
     {
-    case 2:
+        // 3.1 read
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        int n = 0;
+        if(isBinaryIn)
         {
-            const int dim = 2;
-            H2ONaCl::LookUpTableForest_2D* pLUT = (H2ONaCl::LookUpTableForest_2D*)sw.m_pLUT;
-            LOOKUPTABLE_FOREST::Quadrant<dim,H2ONaCl::FIELD_DATA<dim> > *targetLeaf = NULL;
-            FILE* fp = NULL;
-            fp = fopen("lookup_result.csv", "w");
-            if(!fp)ERROR("Open file failed: lookup_result.txt");
-            double* props = new double[pLUT->m_map_props.size()];
-            double xyz_min_target[dim];
-            fprintf(fp, "Phase region\tNeed_refine");
-            for (auto &m : pLUT->m_map_props)
+            n = (int)min(size_chunk, num_points - num_done);
+            const double* xyz = xyz_mapped ? xyz_mapped + num_done*3 : NULL;
+            if(!xyz_mapped)
             {
-                fprintf(fp, "\t%s", m.second.longName);
+                buffer_in.resize(n*3);
+                if(fread(buffer_in.data(), sizeof(double)*3, n, fpin) != (size_t)n)ERROR("Read file failed: "+filename_in);
+                xyz = buffer_in.data();
             }
-            fprintf(fp, "\n");
-            
-            for (size_t i = 0; i < x.size(); i++)
+        #if USE_OMP == 1
+            #pragma omp parallel for shared(x, y, z, xyz)
+        #endif
+            for (int i = 0; i < n; i++)
             {
-                targetLeaf = sw.lookup(props, xyz_min_target, x[i], y[i]);
-                fprintf(fp, "%d\t%d", targetLeaf->qData.leaf->user_data->phaseRegion_cell, targetLeaf->qData.leaf->user_data->need_refine);
-                for (size_t j = 0; j < pLUT->m_map_props.size(); j++)
-                {
-                    fprintf(fp, "\t%f", props[j]);
-                }
-                fprintf(fp, "\n");
-                if(targetLeaf->qData.leaf->user_data->phaseRegion_cell == H2ONaCl::MixPhaseRegion)ind++;
+                x[i] = xyz[i*3];
+                y[i] = xyz[i*3 + 1];
+                z[i] = xyz[i*3 + 2];
             }
-            fclose(fp);
-            delete[] props;
+        }else
+        {
+            n = (int)read_text_points(fpin, size_chunk, x.data(), y.data(), z.data());
         }
-        break;
-    case 3:
+        if(n == 0)break;
+        time_read += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        // 3.2 interpolate all points, then calculate the points in the leaves which need refine
+        start = std::chrono::steady_clock::now();
+        const double* z_lut = sw.m_dim_lut == 3 ? z.data() : NULL;
+        num_refine += sw.lookup_batch_deferred(n, x.data(), y.data(), z_lut, pProps.data(), index_refine, phaseRegion.data(), need_refine.data());
+        for (int i = 0; i < n; i++)
         {
-            const int dim = 3;
-            H2ONaCl::LookUpTableForest_3D* pLUT = (H2ONaCl::LookUpTableForest_3D*)sw.m_pLUT;
-            LOOKUPTABLE_FOREST::Quadrant<dim,H2ONaCl::FIELD_DATA<dim> > *targetLeaf = NULL;
-            FILE* fp = NULL;
-            fp = fopen("lookup_result.csv", "w");
-            if(!fp)ERROR("Open file failed: lookup_result.txt");
-            double* props = new double[pLUT->m_map_props.size()];
-            double xyz_min_target[dim];
-            fprintf(fp, "Phase region\tNeed_refine");
-            for (auto &m : pLUT->m_map_props)
+            if(phaseRegion[i] == H2ONaCl::MixPhaseRegion)num_mix++;
+        }
+        sw.cal_deferred(index_refine, x.data(), y.data(), z_lut, pProps.data());
+        time_lookup += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        // 3.3 write
+        start = std::chrono::steady_clock::now();
+        if(isBinaryOut)
+        {
+            char* records = records_mapped ? records_mapped + size_header + num_done*size_record : NULL;
+            if(!records_mapped)
             {
-                fprintf(fp, "\t%s", m.second.longName);
+                buffer_out.resize(n*size_record);
+                records = buffer_out.data();
             }
-            fprintf(fp, "\n");
-
-            for (size_t i = 0; i < x.size(); i++)
+        #if USE_OMP == 1
+            #pragma omp parallel for shared(records, phaseRegion, need_refine, props)
+        #endif
+            for (int i = 0; i < n; i++)
             {
-                targetLeaf = sw.lookup(props, xyz_min_target, x[i], y[i], z[i]);
-                fprintf(fp, "%d\t%d", targetLeaf->qData.leaf->user_data->phaseRegion_cell, targetLeaf->qData.leaf->user_data->need_refine);
-                for (size_t j = 0; j < pLUT->m_map_props.size(); j++)
+                char* record = records + i*size_record;
+                int flags[2] = {phaseRegion[i], need_refine[i]};
+                memcpy(record, flags, sizeof(flags));
+                for (size_t j = 0; j < num_props; j++)memcpy(record + sizeof(flags) + j*sizeof(double), &props[j][i], sizeof(double));
+            }
+            if(!records_mapped)fwrite(records, size_record, n, fpout);
+        }else
+        {
+            int num_blocks = (n + size_block_text - 1)/size_block_text;
+        #if USE_OMP == 1
+            #pragma omp parallel for schedule(dynamic) shared(text_blocks, phaseRegion, need_refine, props)
+        #endif
+            for (int b = 0; b < num_blocks; b++)
+            {
+                string& text = text_blocks[b];
+                char str[512]; //"%f" of the largest double has 316 characters
+                text.clear();
+                for (int i = b*size_block_text; i < min(n, (b + 1)*size_block_text); i++)
                 {
-                    fprintf(fp, "\t%f", props[j]);
+                    int len = snprintf(str, sizeof(str), "%d\t%d", phaseRegion[i], need_refine[i]);
+                    text.append(str, min(len, (int)sizeof(str)-1));
+                    for (size_t j = 0; j < num_props; j++)
+                    {
+                        len = snprintf(str, sizeof(str), "\t%f", props[j][i]);
+                        text.append(str, min(len, (int)sizeof(str)-1));
+                    }
+                    text += '\n';
                 }
-                fprintf(fp, "\n");
-                if(targetLeaf->qData.leaf->user_data->phaseRegion_cell == H2ONaCl::MixPhaseRegion)ind++;
             }
-            fclose(fp);
-            delete[] props;
+            for (int b = 0; b < num_blocks; b++)fwrite(text_blocks[b].data(), 1, text_blocks[b].size(), fpout);
         }
-        break;
-    default:
-        break;
+        time_write += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        num_done += n;
+        if(isBinaryIn && num_done == num_points)break;
+    }
+    // 4. close files, the number of points of text input is only known now
+    if(isBinaryOut && !isBinaryIn)
+    {
+        unsigned long long num_points_done = num_done;
+        fseek(fpout, 0, SEEK_SET);
+        fwrite(&num_points_done, sizeof(unsigned long long), 1, fpout);
     }
-    printf("All %d/%ld (%.2f %%) points close to phase boundary.\n", ind, x.size(), ind/(double)x.size()*100);
-    STATUS_time("Searching done", clock() - start);
-    // // write result to file
-    // STATUS("Writting results to file");
-    // ofstream fout("lookup_result.csv");
-    // if(!fout)ERROR("Open file failed: lookup_result.csv");
-    // fout<<"x\ty\tz\tphase region index\tphase region name"<<endl;
-    // for (size_t i = 0; i < x.size(); i++)
-    // {
-    //     fout<<x[i]<<"\t"<<y[i]<<"\t"<<z[i]<<"\t"<<pb_lookup[i]<<"\t"<<sw.m_phaseRegion_name[pb_lookup[i]]<<endl;
-    // }
-    
-    // fout.close();
+    unmap_file((char*)xyz_mapped, length_in);
+    unmap_file(records_mapped, length_out);
+    fclose(fpin);
+    fclose(fpout);
+    double time_all = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_all).count();
+    if(num_done == 0)ERROR("No point is read from "+filename_in);
 
+    printf("All %zu/%zu (%.2f %%) points close to phase boundary, %zu (%.2f %%) points calculated by EOS.\n", num_mix, num_done, num_mix/(double)num_done*100, num_refine, num_refine/(double)num_done*100);
+    printf("Read: %.3f s, lookup: %.3f s, write: %.3f s\n", time_read, time_lookup, time_write);
+    STATUS("Looking up done, "+to_string(num_done)+" points in "+to_string(time_all)+" s: "+to_string((size_t)(num_done/time_all))+" points/s");
     return 0;
-}
\ No newline at end of file
+}
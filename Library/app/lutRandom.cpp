@@ -4,8 +4,11 @@
 
 int main(int argc, char** argv)
 {
-    if(argc!=3)ERROR("Usage: "+string(argv[0])+" myLUT.bin 1000");
-    
+    if(argc!=3 && argc!=4)ERROR("Usage: "+string(argv[0])+" myLUT.bin 1000 [Random.xyz|Random.bin]");
+    // the points are written as text, or as 3 doubles per point if the file name ends with .bin, see lutLookup
+    string filename = argc==4 ? string(argv[3]) : "Random.xyz";
+    bool isBinary = filename.size() > 4 && filename.substr(filename.size() - 4) == ".bin";
+
     
     int m_dim_lut = LOOKUPTABLE_FOREST::get_dim_from_binary(argv[1]);
     int n_randSample = atoi(argv[2]);
@@ -16,13 +19,15 @@ int main(int argc, char** argv)
         {
             H2ONaCl::LookUpTableForest_2D lut_2d(argv[1], NULL);
             FILE* fp = NULL;
-            fp = fopen("Random.xyz", "w");
-            if(!fp)ERROR("Open file failed: random.xyz");
+            fp = fopen(filename.c_str(), isBinary ? "wb" : "w");
+            if(!fp)ERROR("Open file failed: "+filename);
             for (size_t i = 0; i < n_randSample; i++)
             {
                 x = (rand()/(double)RAND_MAX)*(lut_2d.m_xyz_max[0] - lut_2d.m_xyz_min[0]) + lut_2d.m_xyz_min[0];
                 y = (rand()/(double)RAND_MAX)*(lut_2d.m_xyz_max[1] - lut_2d.m_xyz_min[1]) + lut_2d.m_xyz_min[1];
-                fprintf(fp, "%f %f %f\n", x, y, lut_2d.m_constZ);
+                z = lut_2d.m_constZ;
+                if(isBinary){ double xyz[3] = {x, y, z}; fwrite(xyz, sizeof(double), 3, fp);}
+                else fprintf(fp, "%f %f %f\n", x, y, z);
             }
             fclose(fp);
         }
@@ -31,14 +36,15 @@ int main(int argc, char** argv)
         {
             H2ONaCl::LookUpTableForest_3D lut_3d(argv[1], NULL);
             FILE* fp = NULL;
-            fp = fopen("Random.xyz", "w");
-            if(fp == NULL)ERROR("Open file failed: Random.xyz");
+            fp = fopen(filename.c_str(), isBinary ? "wb" : "w");
+            if(fp == NULL)ERROR("Open file failed: "+filename);
             for (size_t i = 0; i < n_randSample; i++)
             {
                 x = (rand()/(double)RAND_MAX)*(lut_3d.m_xyz_max[0] - lut_3d.m_xyz_min[0]) + lut_3d.m_xyz_min[0];
                 y = (rand()/(double)RAND_MAX)*(lut_3d.m_xyz_max[1] - lut_3d.m_xyz_min[1]) + lut_3d.m_xyz_min[1];
                 z = (rand()/(double)RAND_MAX)*(lut_3d.m_xyz_max[2] - lut_3d.m_xyz_min[2]) + lut_3d.m_xyz_min[2];
-                fprintf(fp, "%f %f %f\n", x, y, z);
+                if(isBinary){ double xyz[3] = {x, y, z}; fwrite(xyz, sizeof(double), 3, fp);}
+                else fprintf(fp, "%f %f %f\n", x, y, z);
             }
             fclose(fp);
         }
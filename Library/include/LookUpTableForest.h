@@ -2,18 +2,32 @@
 #define LOOKUPTABLEFOREST_H
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <chrono>
+#include <new>
+#include <type_traits>
 using namespace std;
 #include <cmath>
 // #include "H2ONaCl.H" 
 #if USE_OMP == 1
     #include <omp.h>
 #endif
+#ifndef _WIN32
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
 namespace LOOKUPTABLE_FOREST
 {
     #define MAX_FOREST_LEVEL 29
     #define ExtensionName_PointIndexFile "pi"
+    #define LUT_FILE_MAGIC "SWEOSLUT"
+    #define LUT_FILE_VERSION 1
+    #define LUT_FILE_ALIGNMENT 64 //alignment of the sections in the single-file LUT
     struct Quad_index
     {
         int i = 0, j = 0, k = 0;
@@ -23,33 +37,97 @@ namespace LOOKUPTABLE_FOREST
         }
     };
     typedef unsigned int int_pointIndex;
+    /**
+     * @brief Memory layout of the property array of the unique points.
+     * 
+     */
+    enum PROPS_LAYOUT {
+        PROPS_LAYOUT_AOS,   /**< Point major: all properties of a point are stored together, value (i, j) is data[i*num_props + j]. The same order as the single-file LUT. */
+        PROPS_LAYOUT_SOA    /**< Property major: every property is a contiguous column, value (i, j) is data[j*num_points + i]. */
+    };
+    /**
+     * @brief Properties on the unique points of the leaves, stored in one contiguous array of num_points*num_props values.
+     * Value of property j on point i is data[i*stride_point + j*stride_prop] for both layouts.
+     * 
+     */
     struct PropsData
     {
-        double** data = NULL;
+        double* data = NULL;
         int_pointIndex num_points = 0;
         int num_props = 0;
+        PROPS_LAYOUT layout = PROPS_LAYOUT_AOS;
+        size_t stride_point = 0;
+        size_t stride_prop = 0;
+        bool is_external = false; //if true, data points to an external buffer, e.g. a memory-mapped LUT file, nothing is owned.
+        inline double& at(size_t ind_point, int ind_prop){return data[ind_point*stride_point + ind_prop*stride_prop];};
+        inline double* column(int ind_prop){return data + (size_t)ind_prop*num_points;}; //only valid for PROPS_LAYOUT_SOA
+        inline double* point(size_t ind_point){return data + ind_point*num_props;}; //only valid for PROPS_LAYOUT_AOS
+        void set_strides()
+        {
+            stride_point = layout == PROPS_LAYOUT_AOS ? num_props : 1;
+            stride_prop = layout == PROPS_LAYOUT_AOS ? 1 : num_points;
+        }
         void create()
         {
             if(num_props>0)
             {
-                data = new double*[num_points];
-                for (int_pointIndex i = 0; i < num_points; i++)
+                data = new double[(size_t)num_points*num_props];
+                set_strides();
+            }
+        }
+        /**
+         * @brief Use an external buffer in the given layout, e.g. the property section of a memory-mapped LUT file.
+         * 
+         */
+        void attach(double* buffer, PROPS_LAYOUT layout_buffer)
+        {
+            data = buffer;
+            layout = layout_buffer;
+            is_external = true;
+            set_strides();
+        }
+        /**
+         * @brief Change the layout, the values are transposed if the array exists. An external buffer can not be transposed.
+         * 
+         * @return true if the array is in the required layout afterwards
+         */
+        bool set_layout(PROPS_LAYOUT layout_new)
+        {
+            if(layout_new == layout)return true;
+            if(!data)
+            {
+                layout = layout_new;
+                return true;
+            }
+            if(is_external)return false;
+            double* data_new = new double[(size_t)num_points*num_props];
+            PropsData tmp;
+            tmp.data = data_new;
+            tmp.num_points = num_points;
+            tmp.num_props = num_props;
+            tmp.layout = layout_new;
+            tmp.set_strides();
+            for (size_t i = 0; i < num_points; i++)
+            {
+                for (int j = 0; j < num_props; j++)
                 {
-                    data[i] = new double[num_props];
+                    tmp.at(i, j) = at(i, j);
                 }
             }
+            delete[] data;
+            data = data_new;
+            layout = layout_new;
+            set_strides();
+            return true;
         }
         void clear()
         {
             if(data) //need to check where the data array is created or not, e.g., lutInfo, doesn't create data array.
             {
-                for (int_pointIndex i = 0; i < num_points; i++)
-                {
-                    delete[] data[i];
-                    data[i] = NULL;
-                }
-                delete[] data;
+                if(!is_external)delete[] data;
+                data = NULL;
                 num_points = 0;
+                is_external = false;
             }
         }
     };
@@ -85,6 +163,426 @@ namespace LOOKUPTABLE_FOREST
         USER_DATA           *user_data = NULL;
         unsigned int index_props[1<<dim]; //index of property on each node.
     };
+
+    /**
+     * @brief Slab allocator of one node type of the forest. Objects are carved from blocks of block_size objects, a released object is kept in a free list for reuse, 
+     * the memory is only returned to the system by clear(), all at once. It is not thread-safe, every thread has its own pools, see NodeArena.
+     * 
+     */
+    template <typename T>
+    class SlabPool
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "SlabPool never calls destructors");
+        static const size_t block_size = 1024;
+        vector<T*> m_blocks;
+        size_t m_num_used_last; //number of objects carved from the last block
+        vector<T*> m_free;
+        long int m_num_alive; //may be negative in one pool, because an object can be released by another thread than the one allocated it
+    public:
+        SlabPool():m_num_used_last(block_size), m_num_alive(0){};
+        ~SlabPool(){clear();};
+        inline T* allocate()
+        {
+            void* p;
+            if(!m_free.empty())
+            {
+                p = m_free.back();
+                m_free.pop_back();
+            }else
+            {
+                if(m_num_used_last == block_size)
+                {
+                    m_blocks.push_back((T*)::operator new(sizeof(T)*block_size));
+                    m_num_used_last = 0;
+                }
+                p = m_blocks.back() + m_num_used_last++;
+            }
+            m_num_alive++;
+            return new (p) T;
+        };
+        inline void release(T* p)
+        {
+            m_free.push_back(p);
+            m_num_alive--;
+        };
+        void clear()
+        {
+            for (size_t i = 0; i < m_blocks.size(); i++)::operator delete(m_blocks[i]);
+            vector<T*>().swap(m_blocks);
+            vector<T*>().swap(m_free);
+            m_num_used_last = block_size;
+            m_num_alive = 0;
+        };
+        inline size_t bytes_reserved(){return m_blocks.size()*block_size*sizeof(T) + m_free.capacity()*sizeof(T*);};
+        inline long int num_alive(){return m_num_alive;};
+    };
+
+    /**
+     * @brief Per-thread arena of the nodes (Quadrant, LeafQuad, NonLeafQuad and USER_DATA) of the pointer-based forest. 
+     * The refinement tasks allocate from the pools of the thread they run on, so they do not contend on the global allocator, 
+     * and the whole tree is released at once by clear() instead of walking it.
+     * 
+     */
+    template <int dim, typename USER_DATA>
+    class NodeArena
+    {
+    public:
+        static const int max_threads = 1024;
+    private:
+        struct ThreadPools
+        {
+            SlabPool<Quadrant<dim,USER_DATA> > quads;
+            SlabPool<LeafQuad<dim,USER_DATA> > leaves;
+            SlabPool<NonLeafQuad<dim,USER_DATA> > nonleaves;
+            SlabPool<USER_DATA> user_data;
+        };
+        ThreadPools* m_pools[max_threads]; //created by the owner thread when it allocates the first node, so no lock is needed
+        inline ThreadPools& pools()
+        {
+            int ind = 0;
+        #if USE_OMP == 1
+            ind = omp_get_thread_num(); //less than max_threads, see check_num_threads
+        #endif
+            if(!m_pools[ind])m_pools[ind] = new ThreadPools;
+            return *m_pools[ind];
+        };
+        NodeArena(const NodeArena&);
+        NodeArena& operator=(const NodeArena&);
+    public:
+        NodeArena(){for (int i = 0; i < max_threads; i++)m_pools[i] = NULL;};
+        ~NodeArena(){clear();};
+        inline Quadrant<dim,USER_DATA>* new_quadrant(){return pools().quads.allocate();};
+        inline LeafQuad<dim,USER_DATA>* new_leaf(){return pools().leaves.allocate();};
+        inline NonLeafQuad<dim,USER_DATA>* new_nonleaf(){return pools().nonleaves.allocate();};
+        inline USER_DATA* new_user_data(){return pools().user_data.allocate();};
+        inline void release_leaf(LeafQuad<dim,USER_DATA>* leaf){pools().leaves.release(leaf);};
+        inline void release_user_data(USER_DATA* data){pools().user_data.release(data);};
+        /**
+         * @brief Check the number of threads against max_threads, it must be called before entering a parallel region which allocates nodes.
+         */
+        void check_num_threads()
+        {
+        #if USE_OMP == 1
+            int num_threads = omp_in_parallel() ? omp_get_num_threads() : omp_get_max_threads();
+            if(num_threads > max_threads)ERROR("Number of threads ("+to_string(num_threads)+") exceeds the limit of the node arena: "+to_string(max_threads));
+        #endif
+        };
+        /**
+         * @brief Release all the nodes, must not be called in a parallel region.
+         */
+        void clear()
+        {
+            for (int i = 0; i < max_threads; i++)
+            {
+                delete m_pools[i];
+                m_pools[i] = NULL;
+            }
+        };
+        /**
+         * @brief Memory footprint of the arena.
+         * 
+         * @param bytes_reserved [out] memory allocated from the system
+         * @param bytes_used [out] memory of the living nodes
+         * @return int number of threads which have allocated nodes
+         */
+        int footprint(size_t& bytes_reserved, size_t& bytes_used)
+        {
+            int num_threads = 0;
+            long int num_quads = 0, num_leaves = 0, num_nonleaves = 0, num_user_data = 0;
+            bytes_reserved = 0;
+            for (int i = 0; i < max_threads; i++)
+            {
+                if(!m_pools[i])continue;
+                num_threads++;
+                bytes_reserved += m_pools[i]->quads.bytes_reserved() + m_pools[i]->leaves.bytes_reserved() + m_pools[i]->nonleaves.bytes_reserved() + m_pools[i]->user_data.bytes_reserved();
+                num_quads += m_pools[i]->quads.num_alive();
+                num_leaves += m_pools[i]->leaves.num_alive();
+                num_nonleaves += m_pools[i]->nonleaves.num_alive();
+                num_user_data += m_pools[i]->user_data.num_alive();
+            }
+            bytes_used = num_quads*sizeof(Quadrant<dim,USER_DATA>) + num_leaves*sizeof(LeafQuad<dim,USER_DATA>) + num_nonleaves*sizeof(NonLeafQuad<dim,USER_DATA>) + num_user_data*sizeof(USER_DATA);
+            return num_threads;
+        };
+    };
+
+    /**
+     * @brief Morton (Z-order) key of a quadrant. The bits of the integer coordinates i, j (and k) are interleaved as ...k1j1i1k0j0i0, 
+     * which gives exactly the child order (z*4 + y*2 + x) of the pointer-based forest. 
+     * So sorting the leaves by key is the same as the depth-first traversal order of the tree.
+     * 
+     */
+    typedef unsigned long long MortonKey;
+
+    inline MortonKey morton_split2(unsigned int a)
+    {
+        MortonKey x = a;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+        x = (x | (x << 8))  & 0x00FF00FF00FF00FFULL;
+        x = (x | (x << 4))  & 0x0F0F0F0F0F0F0F0FULL;
+        x = (x | (x << 2))  & 0x3333333333333333ULL;
+        x = (x | (x << 1))  & 0x5555555555555555ULL;
+        return x;
+    }
+    inline unsigned int morton_compact2(MortonKey x)
+    {
+        x &= 0x5555555555555555ULL;
+        x = (x | (x >> 1))  & 0x3333333333333333ULL;
+        x = (x | (x >> 2))  & 0x0F0F0F0F0F0F0F0FULL;
+        x = (x | (x >> 4))  & 0x00FF00FF00FF00FFULL;
+        x = (x | (x >> 8))  & 0x0000FFFF0000FFFFULL;
+        x = (x | (x >> 16)) & 0x00000000FFFFFFFFULL;
+        return (unsigned int)x;
+    }
+    inline MortonKey morton_split3(unsigned int a) //only the lowest 21 bits are used
+    {
+        MortonKey x = a & 0x1FFFFF;
+        x = (x | (x << 32)) & 0x001F00000000FFFFULL;
+        x = (x | (x << 16)) & 0x001F0000FF0000FFULL;
+        x = (x | (x << 8))  & 0x100F00F00F00F00FULL;
+        x = (x | (x << 4))  & 0x10C30C30C30C30C3ULL;
+        x = (x | (x << 2))  & 0x1249249249249249ULL;
+        return x;
+    }
+    inline unsigned int morton_compact3(MortonKey x)
+    {
+        x &= 0x1249249249249249ULL;
+        x = (x | (x >> 2))  & 0x10C30C30C30C30C3ULL;
+        x = (x | (x >> 4))  & 0x100F00F00F00F00FULL;
+        x = (x | (x >> 8))  & 0x001F0000FF0000FFULL;
+        x = (x | (x >> 16)) & 0x001F00000000FFFFULL;
+        x = (x | (x >> 32)) & 0x00000000001FFFFFULL;
+        return (unsigned int)x;
+    }
+    template <int dim>
+    inline MortonKey morton_encode(unsigned int i, unsigned int j, unsigned int k)
+    {
+        if(dim==2) return morton_split2(i) | (morton_split2(j) << 1);
+        return morton_split3(i) | (morton_split3(j) << 1) | (morton_split3(k) << 2);
+    }
+    template <int dim>
+    inline void morton_decode(MortonKey key, unsigned int& i, unsigned int& j, unsigned int& k)
+    {
+        if(dim==2)
+        {
+            i = morton_compact2(key);
+            j = morton_compact2(key >> 1);
+            k = 0;
+        }else
+        {
+            i = morton_compact3(key);
+            j = morton_compact3(key >> 1);
+            k = morton_compact3(key >> 2);
+        }
+    }
+
+    /**
+     * @brief Sort keys in ascending order. If OpenMP is enabled, the array is split into one chunk per thread, 
+     * the chunks are sorted in parallel and then merged pairwise.
+     * 
+     */
+    inline void sort_keys(vector<MortonKey>& keys)
+    {
+    #if USE_OMP == 1
+        int num_chunks = omp_get_max_threads();
+        if(num_chunks > 1 && keys.size() > (size_t)num_chunks*1024)
+        {
+            vector<size_t> bounds(num_chunks + 1);
+            for (int i = 0; i <= num_chunks; i++)bounds[i] = keys.size()*i/num_chunks;
+            #pragma omp parallel for shared(keys, bounds)
+            for (int i = 0; i < num_chunks; i++)
+            {
+                std::sort(keys.begin() + bounds[i], keys.begin() + bounds[i+1]);
+            }
+            for (int width = 1; width < num_chunks; width *= 2)
+            {
+                #pragma omp parallel for shared(keys, bounds)
+                for (int i = 0; i < num_chunks - width; i += 2*width)
+                {
+                    int i_end = std::min(i + 2*width, num_chunks);
+                    std::inplace_merge(keys.begin() + bounds[i], keys.begin() + bounds[i+width], keys.begin() + bounds[i_end]);
+                }
+            }
+            return;
+        }
+    #endif
+        std::sort(keys.begin(), keys.end());
+    }
+
+    /**
+     * @brief Thread-safe cache of EOS evaluations on the vertices of a forest. The refinement function stores the result of every vertex it evaluates,
+     * and the property calculation of construct_props_leaves reads it back, so a vertex is evaluated only once in a table build.
+     * The value is an opaque record of fixed size (e.g. H2ONaCl::PROP_H2ONaCl), the key is the vertex key of the forest.
+     * The keys are distributed over shards, every shard has its own lock, so the refinement tasks rarely wait for each other.
+     *
+     */
+    class VertexCache
+    {
+    public:
+        static const int num_shards = 64;
+    private:
+        struct Shard
+        {
+            std::unordered_map<MortonKey, size_t> index; //key -> offset of the value in values
+            vector<char> values;
+        #if USE_OMP == 1
+            omp_lock_t lock;
+        #endif
+        };
+        Shard m_shards[num_shards];
+        size_t m_value_size; //0 means the cache is disabled
+        unsigned long long m_num_hit, m_num_miss;
+        inline Shard& shard(MortonKey key){return m_shards[(key*0x9E3779B97F4A7C15ULL) >> 58];}; //Fibonacci hashing, the top 6 bits select one of the 64 shards
+        inline void lock(Shard& s)
+        {
+        #if USE_OMP == 1
+            omp_set_lock(&s.lock);
+        #endif
+        };
+        inline void unlock(Shard& s)
+        {
+        #if USE_OMP == 1
+            omp_unset_lock(&s.lock);
+        #endif
+        };
+        VertexCache(const VertexCache&);
+        VertexCache& operator=(const VertexCache&);
+    public:
+        VertexCache():m_value_size(0), m_num_hit(0), m_num_miss(0)
+        {
+        #if USE_OMP == 1
+            for (int i = 0; i < num_shards; i++)omp_init_lock(&m_shards[i].lock);
+        #endif
+        };
+        ~VertexCache()
+        {
+        #if USE_OMP == 1
+            for (int i = 0; i < num_shards; i++)omp_destroy_lock(&m_shards[i].lock);
+        #endif
+        };
+        /**
+         * @brief Clear the cache and the counters, and enable it for records of value_size bytes.
+         */
+        void enable(size_t value_size)
+        {
+            release();
+            m_value_size = value_size;
+            m_num_hit = 0;
+            m_num_miss = 0;
+        };
+        /**
+         * @brief Disable the cache and release all the records, the counters are kept for the summary.
+         */
+        void release()
+        {
+            for (int i = 0; i < num_shards; i++)
+            {
+                std::unordered_map<MortonKey, size_t>().swap(m_shards[i].index);
+                vector<char>().swap(m_shards[i].values);
+            }
+            m_value_size = 0;
+        };
+        inline bool is_enabled(){return m_value_size != 0;};
+        /**
+         * @brief Copy the record of key to value if it exists.
+         *
+         * @return true if the key is found (cache hit)
+         */
+        bool find(MortonKey key, void* value)
+        {
+            Shard& s = shard(key);
+            lock(s);
+            std::unordered_map<MortonKey, size_t>::const_iterator it = s.index.find(key);
+            bool isFound = (it != s.index.end());
+            if(isFound)memcpy(value, &s.values[it->second], m_value_size);
+            unlock(s);
+            if(isFound)
+            {
+            #if USE_OMP == 1
+                #pragma omp atomic
+            #endif
+                m_num_hit++;
+            }else
+            {
+            #if USE_OMP == 1
+                #pragma omp atomic
+            #endif
+                m_num_miss++;
+            }
+            return isFound;
+        };
+        /**
+         * @brief Store a record, if the key already exists (e.g. two threads evaluate the same vertex at the same time) the first one is kept.
+         */
+        void insert(MortonKey key, const void* value)
+        {
+            Shard& s = shard(key);
+            lock(s);
+            if(s.index.find(key) == s.index.end())
+            {
+                size_t offset = s.values.size();
+                s.index[key] = offset;
+                s.values.resize(offset + m_value_size);
+                memcpy(&s.values[offset], value, m_value_size);
+            }
+            unlock(s);
+        };
+        size_t size()
+        {
+            size_t num = 0;
+            for (int i = 0; i < num_shards; i++)num += m_shards[i].index.size();
+            return num;
+        };
+        inline unsigned long long num_hit(){return m_num_hit;};
+        inline unsigned long long num_miss(){return m_num_miss;};
+    };
+
+    /**
+     * @brief Leaf of the linear (pointerless) forest. All the leaves are stored contiguously and sorted by the Morton key of their lower left corner, 
+     * the key is calculated at the resolution of max_level, so a leaf is fully described by its key and level.
+     * 
+     */
+    template <int dim, typename USER_DATA> 
+    struct LinearLeaf
+    {
+        MortonKey           key;
+        unsigned char       level;
+        USER_DATA           user_data;
+        int_pointIndex      index_props[1<<dim]; //index of property on each node.
+    };
+
+    /**
+     * @brief A light-weight reference to a leaf, it can be filled by both the pointer-based and the linear storage. 
+     * quad is only valid (not NULL) for the pointer-based storage.
+     * 
+     */
+    template <int dim, typename USER_DATA> 
+    struct LeafRef
+    {
+        int                         level = 0;
+        USER_DATA                   *user_data = NULL;
+        int_pointIndex              *index_props = NULL;
+        Quadrant<dim, USER_DATA>    *quad = NULL;
+    };
+
+    /**
+     * @brief Format of the VTK unstructured grid files written by LookUpTableForest::write_to_vtu and LookUpTableForest::write_to_pvtu.
+     * 
+     */
+    enum VTU_FORMAT {
+        VTU_FORMAT_ASCII,   /**< Inline text data arrays, compression is ignored */
+        VTU_FORMAT_RAW,     /**< Binary data arrays in the raw AppendedData section */
+        VTU_FORMAT_BASE64   /**< Base64 encoded data arrays in the AppendedData section, the file is valid XML */
+    };
+
+    /**
+     * @brief Storage type of the forest.
+     * 
+     */
+    enum LUT_STORAGE {
+        LUT_STORAGE_TREE,   /**< Pointer-based quadtree/octree, every quadrant is a separate heap object. Used to be the only option. */
+        LUT_STORAGE_LINEAR, /**< Linear quadtree/octree, only leaves are stored in a contiguous array in Morton order. Requires dim*max_level <= 63 */
+        LUT_STORAGE_MMAP    /**< Only for loading a single-file LUT: leaves and properties are memory-mapped read-only, so processes on the same node share one copy in page cache. The forest is a linear forest and can not be modified. Only the checksums of the header and property info are verified at loading, see verify_single_binary. Other file formats are loaded as LUT_STORAGE_LINEAR */
+    };
     
     /**
      * @brief For 2D case, define which variable is constant and the variable order of xy.
@@ -120,13 +618,146 @@ namespace LOOKUPTABLE_FOREST
         EOS_ENERGY_H  /**< HPX space */
         };
 
+    /**
+     * @brief Header of the single-file LUT. The file contains the following sections, each of them starts at a multiple of LUT_FILE_ALIGNMENT bytes:
+     * (1) header; (2) property info, num_props records of [int index, propInfo]; (3) leaves, num_leaves records of LinearLeaf<dim,USER_DATA> in Morton order, 
+     * which include the point index; (4) properties, num_points*num_props doubles, all properties of a point are stored together.
+     * All sections are stored in the native byte order as they are in memory, so that the file can be memory-mapped and used directly.
+     * 
+     */
+    struct LUTFileHeader
+    {
+        char                    magic[8];           /**< LUT_FILE_MAGIC, without the terminating null character */
+        unsigned int            version;
+        int                     dim;
+        unsigned int            size_leaf;          /**< sizeof(LinearLeaf<dim,USER_DATA>), used to check the data layout */
+        unsigned int            size_user_data;
+        int                     TorH;
+        int                     const_which_var;
+        double                  xyz_min[3];
+        double                  xyz_max[3];
+        double                  constZ;
+        double                  length_scale[3];
+        int                     min_level;
+        int                     max_level;
+        int                     num_node_per_quad;
+        int                     num_props;
+        long long               num_quads;
+        long long               num_leaves;
+        long long               num_points;
+        long long               num_need_refine;
+        RMSD_RefineCriterion    rmsd_criterion;
+        unsigned long long      offset_props_info;
+        unsigned long long      offset_leaves;
+        unsigned long long      offset_props;
+        unsigned long long      file_size;
+        unsigned long long      checksum_props_info;
+        unsigned long long      checksum_leaves;
+        unsigned long long      checksum_props;
+        unsigned long long      checksum_header;    /**< checksum of the header, calculated with checksum_header = 0 */
+    };
+
+    /**
+     * @brief 64-bit FNV-1a style checksum, processed 8 bytes per step. It can be calculated chunk by chunk by passing the previous result as hash, 
+     * in this case the size of every chunk except the last one must be a multiple of 8.
+     * 
+     */
+    inline unsigned long long checksum64(const void* buffer, size_t size, unsigned long long hash=14695981039346656037ULL)
+    {
+        const unsigned long long prime = 1099511628211ULL;
+        const unsigned char* p = (const unsigned char*)buffer;
+        size_t num_words = size/8;
+        unsigned long long word;
+        for (size_t i = 0; i < num_words; i++)
+        {
+            memcpy(&word, p + i*8, 8);
+            hash = (hash ^ word) * prime;
+        }
+        for (size_t i = num_words*8; i < size; i++)
+        {
+            hash = (hash ^ p[i]) * prime;
+        }
+        return hash;
+    }
+
+    inline bool is_single_binary(string filename)
+    {
+        FILE* fpin = fopen(filename.c_str(), "rb");
+        if(!fpin)return false;
+        char magic[8] = {0};
+        size_t n = fread(magic, sizeof(char), 8, fpin);
+        fclose(fpin);
+        return n == 8 && strncmp(magic, LUT_FILE_MAGIC, 8) == 0;
+    }
+
+    /**
+     * @brief Verify all checksums of a single-file LUT, i.e. header, property info, leaves and properties. 
+     * Loading a LUT by memory mapping only verifies the header and the property info, so that the startup does not read the whole file, 
+     * use this function (or lutInfo with the verify option) to check the data after copying or transferring a LUT file.
+     * The file is read chunk by chunk, the memory does not depend on the size of the file.
+     * 
+     * @return true if all checksums are correct
+     */
+    inline bool verify_single_binary(string filename)
+    {
+        if(!is_single_binary(filename))
+        {
+            WARNING("It is not a single-file LUT: "+filename);
+            return false;
+        }
+        FILE* fpin = fopen(filename.c_str(), "rb");
+        if(!fpin)ERROR("Open file failed: "+filename);
+        LUTFileHeader header;
+        bool isValid = fread(&header, sizeof(LUTFileHeader), 1, fpin) == 1;
+        LUTFileHeader header_copy = header;
+        header_copy.checksum_header = 0;
+        if(!isValid || checksum64(&header_copy, sizeof(LUTFileHeader)) != header.checksum_header)
+        {
+            fclose(fpin);
+            WARNING("Checksum of the header failed, the LUT file is corrupted: "+filename);
+            return false;
+        }
+        const char* names[3] = {"property info", "leaves", "properties"};
+        unsigned long long offsets[3] = {header.offset_props_info, header.offset_leaves, header.offset_props};
+        unsigned long long sizes[3] = {header.num_props*(sizeof(int) + sizeof(propInfo)), (unsigned long long)header.num_leaves*header.size_leaf, header.num_points*header.num_props*sizeof(double)};
+        unsigned long long checksums[3] = {header.checksum_props_info, header.checksum_leaves, header.checksum_props};
+        vector<char> chunk(1<<24); //multiple of 8
+        for (int i = 0; i < 3 && isValid; i++)
+        {
+            unsigned long long hash = checksum64(NULL, 0);
+            fseek(fpin, offsets[i], SEEK_SET);
+            for (unsigned long long done = 0; done < sizes[i] && isValid; )
+            {
+                size_t num = (size_t)std::min((unsigned long long)chunk.size(), sizes[i] - done);
+                isValid = fread(chunk.data(), sizeof(char), num, fpin) == num;
+                hash = checksum64(chunk.data(), num, hash);
+                done += num;
+            }
+            if(!isValid || hash != checksums[i])
+            {
+                WARNING("Checksum of the "+string(names[i])+" failed, the LUT file is corrupted: "+filename);
+                isValid = false;
+            }
+        }
+        fclose(fpin);
+        return isValid;
+    }
+
     inline int get_dim_from_binary(string filename)
     {
         FILE* fpin = NULL;
         fpin = fopen(filename.c_str(), "rb");
         if(!fpin)ERROR("Open file failed: "+filename);
         int dim0;
-        fread(&dim0, sizeof(dim0), 1, fpin);
+        if(is_single_binary(filename))
+        {
+            LUTFileHeader header;
+            fread(&header, sizeof(LUTFileHeader), 1, fpin);
+            dim0 = header.dim;
+        }else
+        {
+            fread(&dim0, sizeof(dim0), 1, fpin);
+        }
         fclose(fpin);
         return dim0;
     }
@@ -147,21 +778,66 @@ namespace LOOKUPTABLE_FOREST
         double m_length_scale[dim]; /**< The reference space is a square or a cube with length=2^{MAX_FOREST_LEVEL}, so the length scale in x,y,z axis is calculated as, e.g. length_scale[0] = (m_xyz_max[0] - m_xyz_min[0])/length, so the length of a quadrant is len_quad = 2^{MAX_FOREST_LEVEL - level}, so its real length in x-axis is len_quad*length_scale[0] */
         Quadrant<dim,USER_DATA> m_root;
         void init_Root(Quadrant<dim,USER_DATA>& quad);
-        void release_quadrant_data(Quadrant<dim,USER_DATA>* quad);
-        void release_leaves(Quadrant<dim,USER_DATA>* quad);
+        NodeArena<dim,USER_DATA> m_arena; /**< all the nodes of the pointer-based forest except the root are allocated from the arena */
         void getLeaves(vector<Quadrant<dim,USER_DATA>* >& leaves, long int& quad_counts, Quadrant<dim,USER_DATA>* quad);
         void refine(Quadrant<dim,USER_DATA>* quad, double xmin_quad, double ymin_quad, double zmin_quad, bool (*is_refine)(LookUpTableForest<dim,USER_DATA>* forest, Quadrant<dim,USER_DATA>* quad, double xmin_quad, double ymin_quad, double zmin_quad, int max_level));
+        void create_children(Quadrant<dim,USER_DATA>* quad);
         void write_vtk_cellData(ofstream* fout, string type, string name, string format);
+        /**
+         * @brief Write the valid leaves index_cells[0, num_cells) to a .vtu file, only the points of these leaves are written and the connectivity is renumbered. 
+         * It does not exit on errors, so it can be called in a parallel region.
+         * 
+         * @param fp File opened by the caller for binary writing, it is closed when it returns
+         * @param unique_points ijk of all the unique points, see get_unique_points
+         * @return false if writing or closing the file failed
+         */
+        bool write_vtu_piece(FILE* fp, const vector<LeafRef<dim,USER_DATA> >& leaves, const size_t* index_cells, size_t num_cells, const vector<Quad_index>& unique_points, VTU_FORMAT format, bool compress);
+        void get_valid_leaves(vector<LeafRef<dim,USER_DATA> >& leaves, vector<size_t>& index_valid_leaves);
         void searchQuadrant(Quadrant<dim,USER_DATA>* quad_source, Quadrant<dim,USER_DATA> *&quad_target, double* xyz_min_target, double x_ref, double y_ref, double z_ref);
         void init(double xyz_min[dim], double xyz_max[dim], int max_level, size_t data_size, void* eosPointer);
         void write_forest(FILE* fpout, FILE* fpout_point_index, Quadrant<dim,USER_DATA>* quad, int order_child, bool is_write_data);
         void read_forest(FILE* fpin_forest, FILE* fpin_point_index, Quadrant<dim,USER_DATA>* quad, int order_child);
         void construct_map2dat();
-        void get_unique_points_leaves(std::map<Quad_index, int_pointIndex>& map_unique_points, int& num_leaves, long int& num_quads, int& num_need_refine, Quadrant<dim,USER_DATA>* quad, Quad_index ijk_quad, unsigned int length_quad);
-        void pass_props_pointer_leaves(std::map<Quad_index, int_pointIndex>& map_unique_points, Quadrant<dim,USER_DATA>* quad, Quad_index ijk_quad, unsigned int length_quad);
         void read_props_from_binary(string filename_forest);
         bool read_forest_from_binary(string filename, bool read_only_header=false);
         string byte2string(double bytes);
+        // linear storage
+        LUT_STORAGE m_storage;
+        int m_linear_shift; /**< MAX_FOREST_LEVEL - m_max_level, shift of the reference coordinate to the resolution of Morton key */
+        vector<LinearLeaf<dim,USER_DATA> > m_linear_leaves;
+        // single-file LUT
+        LinearLeaf<dim,USER_DATA>* m_mapped_leaves; /**< leaves in the memory-mapped LUT file, NULL if the leaves are stored in m_linear_leaves */
+        void*  m_mmap_addr;
+        size_t m_mmap_length;
+        void fill_file_header(LUTFileHeader& header);
+        void read_file_header(const LUTFileHeader& header, string filename);
+        void read_props_info(const char* buffer, int num_props);
+        void read_single_binary(string filename, LUT_STORAGE storage, bool read_only_header);
+        void map_single_binary(string filename);
+        void build_tree(Quadrant<dim,USER_DATA>* quad, const LinearLeaf<dim,USER_DATA>* leaves, size_t num_leaves);
+        void check_linear_resolution();
+        void release_tree();
+        void linearize(Quadrant<dim,USER_DATA>* quad, Quad_index ijk_quad, unsigned int length_quad);
+        bool is_refine_linear_leaf(LinearLeaf<dim,USER_DATA>& leaf, bool (*is_refine)(LookUpTableForest<dim,USER_DATA>* forest, Quadrant<dim,USER_DATA>* quad, double xmin_quad, double ymin_quad, double zmin_quad, int max_level));
+        void refine_linear(bool (*is_refine)(LookUpTableForest<dim,USER_DATA>* forest, Quadrant<dim,USER_DATA>* quad, double xmin_quad, double ymin_quad, double zmin_quad, int max_level));
+        void write_forest(FILE* fpout_forest, FILE* fpout_point_index, size_t& ind_leaf, unsigned char level);
+        void read_forest(FILE* fpin_forest, FILE* fpin_point_index, Quad_index ijk_quad, unsigned int length_quad, unsigned char level);
+        void getLeaves(vector<LeafRef<dim,USER_DATA> >& leaves);
+        // point index
+        void getLeaves(vector<LeafRef<dim,USER_DATA> >& leaves, vector<Quad_index>& ijk_leaves, long int& num_quads, Quadrant<dim,USER_DATA>* quad, Quad_index ijk_quad, unsigned int length_quad);
+        void getLeaves(vector<LeafRef<dim,USER_DATA> >& leaves, vector<Quad_index>& ijk_leaves);
+        inline MortonKey point_key(const Quad_index& ijk);
+        inline void point_ijk(MortonKey key, Quad_index& ijk);
+        /**
+         * @brief Get the unique nodes of all leaves. Every node is encoded as an integer key at max_level resolution, the keys are sorted and made unique, 
+         * so the point index is the position of the key in the sorted array. The order is the same as Quad_index::operator<, 
+         * i.e. the same as the point index constructed by the former std::map implementation.
+         * 
+         * @param unique_points [out] ijk of the unique points, in the order of point index
+         * @param pass_index If true, the point index is also filled to index_props of each leaf
+         */
+        void get_unique_points(vector<Quad_index>& unique_points, bool pass_index);
+        int m_vertex_shift; /**< shift of the reference coordinate to the resolution of vertex key, i.e. max_level+1, so the center of a quadrant at max_level is also a vertex */
     public:
         void    *m_eosPointer;      //pass pointer of EOS object (e.g., the pointer of a object of cH2ONaCl class) to the forest through construct function, this will give access of EOS stuff in the refine call back function, e.g., calculate phase index and properties
         double  m_constZ;         // only valid when dim==2, i.e., 2D case, the constant value of third dimension, e.g. in T-P space with constant X.
@@ -177,19 +853,102 @@ namespace LOOKUPTABLE_FOREST
         EOS_ENERGY m_TorH; 
         // double  m_physical_length_quad[MAX_FOREST_LEVEL][dim]; //Optimization: store the length of quad in each dimension as a member data of the forest, therefore don't need to calculate length of quad, just access this 2D array according to the quad level. 
         RMSD_RefineCriterion m_RMSD_RefineCriterion;
+        VertexCache m_vertex_cache; /**< EOS evaluations on vertices shared by the refinement and construct_props_leaves, disabled by default */
+        /**
+         * @brief Enable the vertex cache for records of value_size bytes. The vertex key needs dim*(max_level+2) bits,
+         * so the cache is not enabled (with a warning) if the max_level is too large, the table is still correct but every vertex is evaluated again.
+         *
+         * @return true if the cache is enabled
+         */
+        bool enable_vertex_cache(size_t value_size);
+        /**
+         * @brief Key of a vertex at the resolution of max_level+1. ijk must be on that grid, e.g. a corner or the center of a quadrant.
+         *
+         */
+        inline MortonKey vertex_key(const Quad_index& ijk)
+        {
+            const int bits = m_max_level + 2;
+            MortonKey key = (MortonKey)(ijk.i >> m_vertex_shift) << bits | (MortonKey)(ijk.j >> m_vertex_shift);
+            if(dim==3) key = key << bits | (MortonKey)(ijk.k >> m_vertex_shift);
+            return key;
+        };
         inline void set_min_level(int min_level){m_min_level = min_level;};
         Quadrant<dim,USER_DATA>* get_root(){return &m_root;};
         // int searchQuadrant(double x, double y, double z);
         void searchQuadrant(Quadrant<dim,USER_DATA> *&targetLeaf, double* xyz_min_target, double x, double y, double z);
+        /**
+         * @brief Search the leaf which contains point (x,y,z), works for both pointer-based and linear storage. 
+         * For the linear storage, the leaf is found by a binary search of the Morton key of the point.
+         * 
+         * @param leaf [out] reference of the target leaf
+         * @param xyz_min_target [out] physical coordinate of the lower left corner of the target leaf
+         */
+        void searchLeaf(LeafRef<dim,USER_DATA>& leaf, double* xyz_min_target, double x, double y, double z);
+        /**
+         * @brief Convert the pointer-based forest to a linear forest: leaves are copied to a contiguous array in Morton order and all the quadrants are released. 
+         * Afterwards, refine, searchLeaf, write_to_binary, write_to_vtk and construct_props_leaves work on the linear storage.
+         * 
+         */
+        void linearize();
+        inline LUT_STORAGE get_storage(){return m_storage;};
+        inline LinearLeaf<dim,USER_DATA>* linear_leaves(){return m_mapped_leaves ? m_mapped_leaves : m_linear_leaves.data();};
+        inline size_t num_linear_leaves(){return m_mapped_leaves ? (size_t)m_num_leaves : m_linear_leaves.size();};
+        inline bool is_mapped(){return m_mapped_leaves != NULL;};
         void get_quadrant_physical_length(int level, double physical_length[dim]);
         void refine(bool (*is_refine)(LookUpTableForest<dim,USER_DATA>* forest, Quadrant<dim,USER_DATA>* quad, double xmin_quad, double ymin_quad, double zmin_quad, int max_level));
+        inline void check_num_threads(){m_arena.check_num_threads();}; /**< Check the number of threads of refinement against the limit of the node arena, see NodeArena::check_num_threads */
+        /**
+         * @brief Breadth-first refinement: the quadrants of one level are checked by a parallel loop with dynamic scheduling, then the next level, and the wall-clock time of each level is printed. 
+         * The result is the same as refine, but the threads are not serialized by the recursion at the coarse levels or on deep branches. 
+         * It must be called outside of a parallel region, it opens its own parallel loop for every level.
+         * 
+         */
+        void refine_level(bool (*is_refine)(LookUpTableForest<dim,USER_DATA>* forest, Quadrant<dim,USER_DATA>* quad, double xmin_quad, double ymin_quad, double zmin_quad, int max_level));
         void get_ijk_nodes_quadrant(Quadrant<dim,USER_DATA>* quad, const Quad_index* ijk_quad, int num_nodes_per_quad, Quad_index* ijk);
+        void get_ijk_nodes_quadrant(int level, const Quad_index* ijk_quad, int num_nodes_per_quad, Quad_index* ijk);
         void assemble_data(void (*cal_prop)(LookUpTableForest<dim,USER_DATA>* forest, std::map<Quad_index, double*>& map_ijk2data));
-        void construct_props_leaves(void (*cal_prop)(LookUpTableForest<dim,USER_DATA>* forest, std::map<Quad_index, unsigned int>& map_ijk2data, double** data));
+        /**
+         * @brief Construct point index of the leaves and calculate properties on the unique points.
+         * 
+         * @param cal_prop Callback to calculate properties, props.at(i, j) is property j of the point ijk_points[i]. If NULL, only the point index is constructed (e.g., loading a table without .pi file).
+         */
+        void construct_props_leaves(void (*cal_prop)(LookUpTableForest<dim,USER_DATA>* forest, vector<Quad_index>& ijk_points, PropsData& props));
+        /**
+         * @brief Set the layout of m_props_unique_points_leaves, existing properties are transposed. 
+         * The properties of a memory-mapped LUT stay in PROPS_LAYOUT_AOS (with a warning).
+         * 
+         */
+        void set_props_layout(PROPS_LAYOUT layout);
         void ijk2xyz(const Quad_index* ijk, double& x, double& y, double& z);
+        /**
+         * @brief Inverse of ijk2xyz, the reference coordinate is rounded to the nearest integer.
+         * Used to get the ijk of a quadrant from its physical lower left corner in the refinement function.
+         */
+        void xyz2ijk(double x, double y, double z, Quad_index& ijk);
         void union_ijk2xyz(Quadrant<dim, USER_DATA>* quad, Quad_index& ijk_backup);
         void write_to_vtk(string filename, bool write_data=true, bool isNormalizeXYZ=true);
+        /**
+         * @brief Write the leaves with a known phase region to a VTK unstructured grid file (.vtu). The data arrays are the same as write_to_vtk, 
+         * but with a binary format they are written as appended data by fwrite, optionally zlib-compressed, instead of text.
+         * 
+         * @param compress Compress every data array with the built-in zlib encoder (vtkZLibDataCompressor), only for binary formats
+         */
+        void write_to_vtu(string filename, VTU_FORMAT format=VTU_FORMAT_RAW, bool compress=false);
+        /**
+         * @brief Split the leaves into num_pieces pieces of consecutive leaves (compact regions in Morton order), write the pieces in parallel to 
+         * filename_i.vtu, i=0, ..., num_pieces-1, and a parallel VTK file (.pvtu) referring to them. The points on the boundary of two pieces are written by both pieces.
+         * 
+         * @param filename Name of the .pvtu file
+         */
+        void write_to_pvtu(string filename, int num_pieces, VTU_FORMAT format=VTU_FORMAT_RAW, bool compress=false);
         void write_to_binary(string filename, bool is_write_data=true);
+        /**
+         * @brief Write the forest, point index and properties to a single versioned binary file with checksums, see LUTFileHeader. 
+         * The file can be loaded by the constructor with any storage type, and memory-mapped with LUT_STORAGE_MMAP.
+         * 
+         * @param filename 
+         */
+        void write_to_single_binary(string filename);
         void write_point_index(string filename_forest);
         void write_point_index(FILE* fpout_point_index, Quadrant<dim,USER_DATA>* quad);
         void print_summary();
@@ -217,7 +976,7 @@ namespace LOOKUPTABLE_FOREST
          * @param eosPointer 
          */
         LookUpTableForest(double xy_min[dim], double xy_max[dim], double constZ, CONST_WHICH_VAR const_which_var, EOS_ENERGY TorH, int max_level, std::map<int, propInfo> name_props, void* eosPointer=NULL); //2D case
-        LookUpTableForest(string filename_forest, void* pointer=NULL); //load from exist binary file
+        LookUpTableForest(string filename_forest, void* pointer=NULL, LUT_STORAGE storage=LUT_STORAGE_TREE); //load from exist binary file
         void destory();
         ~LookUpTableForest();
     };
@@ -9,8 +9,12 @@
  * 
  */
 #include <cmath>
+#include <cstddef>
 #ifndef INTERPOLATION
 #define INTERPOLATION
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
 
 // linear
 //       ^
@@ -45,7 +49,7 @@
 
 namespace INTERPOLATION
 {
-    double linear(double x1, double f_x1, double x2, double f_x2, double x)
+    inline double linear(double x1, double f_x1, double x2, double f_x2, double x)
     {
         double result = (x - x1)/(x2-x1)*f_x2  + (x2-x)/(x2-x1)*f_x1;
         return result;
@@ -93,6 +97,154 @@ namespace INTERPOLATION
         }
     }
 
+    /**
+     * @brief a*b + c, fused if the target has FMA, so the scalar loops round the same as the SIMD loops.
+     * 
+     */
+    inline double madd(double a, double b, double c)
+    {
+    #ifdef __FMA__
+        return std::fma(a, b, c);
+    #else
+        return a*b + c;
+    #endif
+    }
+    inline double mul(double a, double b){return a*b;}
+#if defined(__AVX2__)
+    inline __m256d madd(__m256d a, __m256d b, __m256d c)
+    {
+    #ifdef __FMA__
+        return _mm256_fmadd_pd(a, b, c);
+    #else
+        return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+    #endif
+    }
+    inline __m256d mul(__m256d a, __m256d b){return _mm256_mul_pd(a, b);}
+#endif
+#if defined(__AVX512F__) && defined(__FMA__)
+    inline __m512d madd(__m512d a, __m512d b, __m512d c){return _mm512_fmadd_pd(a, b, c);}
+    inline __m512d mul(__m512d a, __m512d b){return _mm512_mul_pd(a, b);}
+#endif
+
+    /**
+     * @brief The same nested interpolation as bilinear_cal for a scalar or a SIMD vector T, each lane is an independent interpolation.
+     * 
+     */
+    template<int dim, typename T>
+    inline T bilinear_cal_lanes(const T coeff[dim][2], const T* values_at_vertices)
+    {
+        T Y1_Z1    = madd(coeff[0][0], values_at_vertices[1], mul(coeff[0][1], values_at_vertices[0]));
+        T Y2_Z1    = madd(coeff[0][0], values_at_vertices[3], mul(coeff[0][1], values_at_vertices[2]));
+        T Z1       = madd(coeff[1][0], Y2_Z1, mul(coeff[1][1], Y1_Z1));
+        if (dim==3)
+        {
+            T Y1_Z2 = madd(coeff[0][0], values_at_vertices[5], mul(coeff[0][1], values_at_vertices[4]));
+            T Y2_Z2 = madd(coeff[0][0], values_at_vertices[7], mul(coeff[0][1], values_at_vertices[6]));
+            T Z2    = madd(coeff[1][0], Y2_Z2, mul(coeff[1][1], Y1_Z2));
+            return madd(coeff[2][0], Z2, mul(coeff[2][1], Z1));
+        }
+        return Z1;
+    }
+
+    /**
+     * @brief Interpolate num_props properties of a quad with the same coefficients. 
+     * Property j of vertex i is nodes[i][j*stride_prop]. If stride_prop==1, i.e. point-major properties, the properties are processed in AVX-512 or AVX2 registers when the target supports them, otherwise one by one.
+     * 
+     * @param result [out] Size is num_props
+     */
+    template<int dim>
+    void bilinear_cal_props(const double coeff[dim][2], const double* const* nodes, size_t stride_prop, int num_props, double* result)
+    {
+        const int num_nodes = 1<<dim;
+        int j = 0;
+        if(stride_prop == 1)
+        {
+            // the last properties are processed by masked load/store, the masked lanes are never read or written
+        #if defined(__AVX512F__) && defined(__FMA__)
+            __m512d coeff_512[dim][2], values_512[1<<dim];
+            for (int d = 0; d < dim; d++)for (int s = 0; s < 2; s++)coeff_512[d][s] = _mm512_set1_pd(coeff[d][s]);
+            for (; j < num_props; j += 8)
+            {
+                __mmask8 mask = num_props - j >= 8 ? 0xFF : (__mmask8)((1<<(num_props - j)) - 1);
+                for (int i = 0; i < num_nodes; i++)values_512[i] = _mm512_maskz_loadu_pd(mask, nodes[i] + j);
+                _mm512_mask_storeu_pd(result + j, mask, bilinear_cal_lanes<dim>(coeff_512, values_512));
+            }
+        #elif defined(__AVX2__)
+            __m256d coeff_256[dim][2], values_256[1<<dim];
+            for (int d = 0; d < dim; d++)for (int s = 0; s < 2; s++)coeff_256[d][s] = _mm256_set1_pd(coeff[d][s]);
+            for (; j < num_props; j += 4)
+            {
+                __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(num_props - j), _mm256_set_epi64x(3, 2, 1, 0));
+                for (int i = 0; i < num_nodes; i++)values_256[i] = _mm256_maskload_pd(nodes[i] + j, mask);
+                _mm256_maskstore_pd(result + j, mask, bilinear_cal_lanes<dim>(coeff_256, values_256));
+            }
+        #endif
+        }
+        double values_at_vertices[1<<dim];
+        for (; j < num_props; j++)
+        {
+            for (int i = 0; i < num_nodes; i++)values_at_vertices[i] = nodes[i][j*stride_prop];
+            result[j] = bilinear_cal_lanes<dim>(coeff, values_at_vertices);
+        }
+    }
+
+    /**
+     * @brief Interpolate num_props properties at the points i_begin, ..., i_begin+num_points-1 which are all in the same quad, the vertex values are read only once per property. 
+     * The coefficients of a block of points are computed first, then every property is interpolated at the whole block, SIMD lanes run over the points.
+     * The result of each point is the same as get_coeff_bilinear + bilinear_cal_props.
+     * 
+     * @param xyz Coordinates of point i are xyz[0][i], xyz[1][i] (, xyz[2][i])
+     * @param result [out] Property j of point i is result[j][i]
+     */
+    template<int dim>
+    void bilinear_cal_props_batch(const double *xyz_min, const double *length, const double* const* nodes, size_t stride_prop, int num_props, const double* const* xyz, int i_begin, int num_points, double** result)
+    {
+        const int num_nodes = 1<<dim;
+        const int size_block = 64;
+        double coeff_block[dim][2][size_block];
+        double coeff[dim][2], xyz_point[dim], values_at_vertices[1<<dim];
+        for (int k_begin = 0; k_begin < num_points; k_begin += size_block)
+        {
+            const int num = num_points - k_begin < size_block ? num_points - k_begin : size_block;
+            for (int k = 0; k < num; k++)
+            {
+                for (int d = 0; d < dim; d++)xyz_point[d] = xyz[d][i_begin + k_begin + k];
+                get_coeff_bilinear<dim>(xyz_min, length, xyz_point, coeff);
+                for (int d = 0; d < dim; d++)for (int s = 0; s < 2; s++)coeff_block[d][s][k] = coeff[d][s];
+            }
+            for (int j = 0; j < num_props; j++)
+            {
+                for (int i = 0; i < num_nodes; i++)values_at_vertices[i] = nodes[i][j*stride_prop];
+                double* result_block = result[j] + i_begin + k_begin;
+                int k = 0;
+            #if defined(__AVX512F__) && defined(__FMA__)
+                __m512d coeff_512[dim][2], values_512[1<<dim];
+                for (int i = 0; i < num_nodes; i++)values_512[i] = _mm512_set1_pd(values_at_vertices[i]);
+                for (; k < num; k += 8)
+                {
+                    __mmask8 mask = num - k >= 8 ? 0xFF : (__mmask8)((1<<(num - k)) - 1);
+                    for (int d = 0; d < dim; d++)for (int s = 0; s < 2; s++)coeff_512[d][s] = _mm512_maskz_loadu_pd(mask, coeff_block[d][s] + k);
+                    _mm512_mask_storeu_pd(result_block + k, mask, bilinear_cal_lanes<dim>(coeff_512, values_512));
+                }
+            #elif defined(__AVX2__)
+                __m256d coeff_256[dim][2], values_256[1<<dim];
+                for (int i = 0; i < num_nodes; i++)values_256[i] = _mm256_set1_pd(values_at_vertices[i]);
+                for (; k < num; k += 4)
+                {
+                    __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(num - k), _mm256_set_epi64x(3, 2, 1, 0));
+                    for (int d = 0; d < dim; d++)for (int s = 0; s < 2; s++)coeff_256[d][s] = _mm256_maskload_pd(coeff_block[d][s] + k, mask);
+                    _mm256_maskstore_pd(result_block + k, mask, bilinear_cal_lanes<dim>(coeff_256, values_256));
+                }
+            #endif
+                for (; k < num; k++)
+                {
+                    for (int d = 0; d < dim; d++)for (int s = 0; s < 2; s++)coeff[d][s] = coeff_block[d][s][k];
+                    result_block[k] = bilinear_cal_lanes<dim>(coeff, values_at_vertices);
+                }
+            }
+        }
+    }
+
     template<int dim>
     void bilinear(const double *xyz_min, const double *length, const double* values_at_vertices, const double* xyz, double& result)
     {
@@ -0,0 +1,82 @@
+/**
+ * @file vtuWriter.h
+ * @brief Binary encodings of the VTK XML formats: appended raw/base64 data arrays with an optional zlib compression.
+ * The zlib streams are created by a small built-in deflate encoder (LZ77 + fixed Huffman codes), so there is no dependency on zlib.
+ *
+ */
+#ifndef VTUWRITER_H
+#define VTUWRITER_H
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstddef>
+
+namespace VTU
+{
+    enum ENCODING
+    {
+        ENCODING_RAW,       /**< Binary bytes after the '_' of the AppendedData section, smallest and fastest */
+        ENCODING_BASE64     /**< Base64 text, the file is still a valid XML file */
+    };
+
+    /**
+     * @brief Append the zlib stream (RFC 1950) of data to out. Blocks which can not be compressed are stored, so the stream is at most a few bytes larger than the data.
+     *
+     * @return Number of bytes appended
+     */
+    size_t zlib_compress(const void* data, size_t size, std::vector<unsigned char>& out);
+
+    /**
+     * @brief Base64 encoder which can be fed in pieces, the padding is only written by finish.
+     *
+     */
+    class Base64Stream
+    {
+    private:
+        FILE* m_fp;
+        unsigned char m_carry[3];
+        int m_num_carry;
+        size_t m_num_chars;
+    public:
+        Base64Stream(FILE* fp) : m_fp(fp), m_num_carry(0), m_num_chars(0){};
+        void write(const void* data, size_t size);
+        void finish();
+        size_t num_chars(){return m_num_chars;};
+        static size_t encoded_size(size_t size){return (size + 2)/3*4;};
+    };
+
+    /**
+     * @brief Data arrays of the AppendedData section of a VTK XML file with header_type="UInt64".
+     * Arrays are registered by add, which returns the offset attribute of the DataArray, and written after the XML part by write.
+     * Without compression the arrays are not copied, so they must stay valid until write.
+     * With compression every array is split into blocks of size_block bytes and each block is a zlib stream, as vtkZLibDataCompressor.
+     *
+     */
+    class AppendedData
+    {
+    private:
+        struct Array
+        {
+            const void* data;
+            unsigned long long size;
+            std::vector<unsigned char> header;  //compression header, only used with compression
+            std::vector<unsigned char> blocks;  //compressed blocks, only used with compression
+        };
+        ENCODING m_encoding;
+        bool m_compress;
+        size_t m_size_block;
+        size_t m_offset;
+        std::vector<Array> m_arrays;
+    public:
+        AppendedData(ENCODING encoding, bool compress, size_t size_block=1<<15);
+        size_t add(const void* data, size_t size);
+        /**
+         * @brief Attributes of the VTKFile element which depend on the encoding, i.e. the compressor.
+         *
+         */
+        std::string file_attributes();
+        void write(FILE* fp);
+    };
+}
+
+#endif
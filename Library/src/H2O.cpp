@@ -3,12 +3,42 @@
 namespace H2O
 {
     cH2O::cH2O(/* args */)
+    :
+    m_Table62(shared_Table62()),
+    m_Table62_Terms(shared_Table62_Terms())
     {
-        //load table 6.2 data in \cite wagner2002iapws
-        LoadTable62(m_Table62);
         m_isHighAccuracy = true; //using high accuracy scheme in Rho function
     }
     
+    const Table62& cH2O::shared_Table62()
+    {
+        //load table 6.2 data in \cite wagner2002iapws only once, the initialization of a local static is thread-safe in C++11
+        static const Table62 table62 = [](){Table62 table; LoadTable62(table); return table;}();
+        return table62;
+    }
+
+    const Table62_Terms& cH2O::shared_Table62_Terms()
+    {
+        static const Table62_Terms terms = []()
+        {
+            const Table62& table62 = shared_Table62();
+            Table62_Terms terms;
+            for (size_t i = 0; i < Table62_Terms::numTerms; i++)
+            {
+                terms.n[i] = table62.n[i];
+                terms.dd[i] = table62.d[i];
+                terms.cc[i] = table62.c[i];
+                terms.tt[i] = table62.t[i];
+                terms.d[i] = (int)table62.d[i];
+                terms.c[i] = (int)table62.c[i];
+                terms.t_int[i] = (int)floor(table62.t[i]);
+                terms.t_eighth[i] = (int)((table62.t[i] - terms.t_int[i])*8); // exact, t_i of the first 7 terms are multiples of 1/8
+            }
+            return terms;
+        }();
+        return terms;
+    }
+    
     cH2O::~cH2O()
     {
     }
@@ -255,6 +285,43 @@ namespace H2O
         }
     }
     double cH2O::Rho(double T, double P)
+    {
+        const int iterMax = 100;
+        double T_K = T + Kelvin;
+        double tau = T_Critic_K/T_K;
+        double RT = R_const*T_K/100.0; // p[bar] = rho*RT*(1 + delta*phi_r_delta)
+        // density bracket of the phase, the same as Rho_Bisection, and initial guess
+        double Rho1 = 1E-6, Rho2 = 1701, Rho0 = P/RT;
+        if(T_K <= T_Critic_K)
+        {
+            if(P <= BoilingCurve(T))
+            {
+                Rho2 = Rho_Vapor_Saturated(T) + 1;
+            }else
+            {
+                Rho1 = Rho_Liquid_Saturated(T) - 1;
+                Rho0 = Rho1 + 1;
+            }
+        }
+        if(Rho0 <= Rho1 || Rho0 >= Rho2)Rho0 = (Rho1 + Rho2)/2.0;
+        // pressure increases with density in the bracket, so the sign of the residual tells which side the root is.
+        for (int n = 0; n < iterMax; n++)
+        {
+            double delta = Rho0/Rho_Critic;
+            Phi_r_STRUCT phi_r;
+            Phi_r_all(delta, tau, phi_r);
+            double dP = Rho0*RT*(1 + delta*phi_r.phi_delta) - P;
+            if(dP > 0)Rho2 = Rho0;
+            else Rho1 = Rho0;
+            double dPdRho = RT*(1 + 2*delta*phi_r.phi_delta + delta*delta*phi_r.phi_deltadelta);
+            double Rho_new = Rho0 - dP/dPdRho;
+            if(fabs(Rho_new - Rho0) <= 1E-12*Rho0)return Rho_new;
+            if(!(dPdRho > 0) || Rho_new < Rho1 || Rho_new > Rho2)Rho_new = (Rho1 + Rho2)/2.0; //bisection
+            Rho0 = Rho_new;
+        }
+        return Rho_Bisection(T, P);
+    }
+    double cH2O::Rho_Bisection(double T, double P)
     {//DEBUG: Rho_Water# in water_prop.vb
         double T_K = T + Kelvin;
         double Rho1 = 0, Rho2 = 0;
@@ -412,131 +479,21 @@ namespace H2O
     }
     double cH2O::Phi_r_delta(double delta, double tau)
     {
-        double sum1 = 0, sum2 = 0, sum3 = 0, sum4 = 0;
-        for (size_t i = 0; i < 7; i++)
-        {
-            sum1 += m_Table62.n[i] * m_Table62.d[i] * pow(delta, m_Table62.d[i] -1) * pow(tau, m_Table62.t[i]);
-        }
-        for (size_t i = 7; i < 51; i++)
-        {
-            sum2 += m_Table62.n[i] * exp(-pow(delta,m_Table62.c[i])) * 
-                    (pow(delta, m_Table62.d[i] -1) * pow(tau, m_Table62.t[i]) * 
-                    (m_Table62.d[i] - m_Table62.c[i]*pow(delta, m_Table62.c[i])));
-        }
-        for (size_t i = 51; i < 54; i++)
-        {
-            sum3 += m_Table62.n[i] * pow(delta,m_Table62.d[i]) * pow(tau, m_Table62.t[i]) * exp(-m_Table62.alpha[i]*pow(delta - m_Table62.epsilon[i], 2.0) - m_Table62.beta[i]*pow(tau - m_Table62.gamma[i], 2.0) ) * (m_Table62.d[i]/delta - 2*m_Table62.alpha[i]*(delta - m_Table62.epsilon[i]) );
-        }
-        double psi = 0, theta = 0, Delta = 0, dpsiddelta = 0, dDeltaddelta = 0, dDeltabiddelta = 0, delta_minus_one_squre = 0, tau_minus_one_squre=0;
-        for (size_t i = 54; i < 56; i++)
-        {
-            delta_minus_one_squre = pow(delta - 1, 2.0);
-            tau_minus_one_squre = pow(tau - 1, 2.0);
-            psi = exp(-m_Table62.C[i]*delta_minus_one_squre - m_Table62.D[i]*tau_minus_one_squre);
-
-            theta = (1-tau) + m_Table62.A[i]*pow(delta_minus_one_squre, 0.5/m_Table62.beta[i]);
-
-            Delta = pow(theta, 2.0) + m_Table62.B[i]*pow(delta_minus_one_squre, m_Table62.a[i]);
-            dpsiddelta = -2*m_Table62.C[i]*(delta - 1) * psi;
-
-            dDeltaddelta = 2*(delta - 1)*(theta * m_Table62.A[i]/m_Table62.beta[i]*pow(delta_minus_one_squre, 0.5/m_Table62.beta[i] - 1) + m_Table62.B[i]*m_Table62.a[i]*pow(delta_minus_one_squre, m_Table62.a[i]-1));
-            if(Delta == 0)
-            {
-                dDeltabiddelta = 0;
-            }else
-            {
-                dDeltabiddelta = dDeltaddelta*m_Table62.b[i]*pow(Delta, m_Table62.b[i]-1);
-            }
-            
-            sum4 += m_Table62.n[i]*(pow(Delta, m_Table62.b[i]) * (psi + delta*dpsiddelta) + dDeltabiddelta*delta*psi);
-        }
-        
-        return sum1+sum2+sum3+sum4;
+        Phi_r_STRUCT phi_r;
+        Phi_r_all(delta, tau, phi_r);
+        return phi_r.phi_delta;
     }
     double cH2O::Phi_r_deltadelta(double delta, double tau)
     {
-        double sum1 = 0, sum2 = 0, sum3 = 0, sum4 = 0;
-        for (size_t i = 0; i < 7; i++)
-        {
-            sum1 += m_Table62.n[i] * m_Table62.d[i] * (m_Table62.d[i] - 1) * pow(delta,m_Table62.d[i] - 2) * pow(tau,m_Table62.t[i]);
-        }
-        for (size_t i = 7; i < 51; i++)
-        {
-            sum2 += m_Table62.n[i] * exp(-pow(delta,m_Table62.c[i])) * (pow(delta,m_Table62.d[i]-2) * pow(tau,m_Table62.t[i]) * ((m_Table62.d[i] - m_Table62.c[i] * pow(delta,m_Table62.c[i])) * (m_Table62.d[i] - 1 - m_Table62.c[i] * pow(delta,m_Table62.c[i])) - pow(m_Table62.c[i],2.0) * pow(delta,m_Table62.c[i])));
-        }
-        for (size_t i = 51; i < 54; i++)
-        {
-            sum3 += m_Table62.n[i] * pow(tau,m_Table62.t[i]) * exp(-m_Table62.alpha[i] * pow(delta - m_Table62.epsilon[i], 2.0) - m_Table62.beta[i] * pow(tau - m_Table62.gamma[i], 2.0)) * (-2 * m_Table62.alpha[i] * pow(delta,m_Table62.d[i]) + 4 * pow(m_Table62.alpha[i], 2.0) * pow(delta,m_Table62.d[i]) * pow(delta-m_Table62.epsilon[i],2.0) - 4 * m_Table62.d[i] * m_Table62.alpha[i] * pow(delta,m_Table62.d[i]-1) * (delta - m_Table62.epsilon[i]) + m_Table62.d[i] * (m_Table62.d[i] - 1) * pow(delta, m_Table62.d[i]-2));
-        }
-        double psi = 0, theta = 0, Delta = 0, dpsiddelta = 0, d2Psiddeltadelta=0, dDeltaddelta = 0, d2Deltaddeltadelta=0, dDeltabiddelta = 0,d2DeltaBIddeltadelta=0, delta_minus_one_squre = 0, tau_minus_one_squre=0;
-        for (size_t i = 54; i < 56; i++)
-        {
-            delta_minus_one_squre = pow(delta - 1, 2.0);
-            tau_minus_one_squre = pow(tau - 1, 2.0);
-            psi = exp(-m_Table62.C[i]*delta_minus_one_squre - m_Table62.D[i]*tau_minus_one_squre);
-            theta = (1-tau) + m_Table62.A[i]*pow(delta_minus_one_squre, 0.5/m_Table62.beta[i]);
-            Delta = pow(theta, 2.0) + m_Table62.B[i]*pow(delta_minus_one_squre, m_Table62.a[i]);
-
-            dDeltaddelta = 2*(delta - 1)*(theta * m_Table62.A[i]/m_Table62.beta[i]*pow(delta_minus_one_squre, 0.5/m_Table62.beta[i] - 1) + m_Table62.B[i]*m_Table62.a[i]*pow(delta_minus_one_squre, m_Table62.a[i]-1));
-
-            dDeltabiddelta = dDeltaddelta*m_Table62.b[i]*pow(Delta, m_Table62.b[i]-1);
-
-            dpsiddelta = -2*m_Table62.C[i]*(delta - 1) * psi;
-
-            d2Psiddeltadelta = (2 * m_Table62.C[i] * pow(delta - 1, 2.0) - 1) * 2 * m_Table62.C[i] * psi;
-            
-            d2Deltaddeltadelta = 1 / (delta - 1) * dDeltaddelta + pow(delta - 1, 2) * (4 * m_Table62.B[i] * m_Table62.a[i] * (m_Table62.a[i] - 1) * pow(pow(delta - 1, 2), m_Table62.a[i]-2) + 2 * pow(m_Table62.A[i], 2)* pow(m_Table62.beta[i], -2) * pow(pow(pow(delta - 1, 2), 0.5/m_Table62.beta[i]-1), 2) + m_Table62.A[i] * theta * 4 / m_Table62.beta[i] * (0.5/ m_Table62.beta[i] - 1) * pow(pow(delta - 1, 2), 0.5/m_Table62.beta[i]-2));
-            
-            d2DeltaBIddeltadelta = m_Table62.b[i] * (pow(Delta, m_Table62.b[i]-1) * d2Deltaddeltadelta + (m_Table62.b[i] - 1) * pow(Delta, m_Table62.b[i]-2) * pow(dDeltaddelta,2));
-
-            sum4 += m_Table62.n[i]*(pow(Delta,m_Table62.b[i]) * (2 * dpsiddelta + delta * d2Psiddeltadelta) + 2 * dDeltabiddelta * (psi + delta * dpsiddelta) + d2DeltaBIddeltadelta * psi * delta);
-        }
-        
-        return sum1+sum2+sum3+sum4;
+        Phi_r_STRUCT phi_r;
+        Phi_r_all(delta, tau, phi_r);
+        return phi_r.phi_deltadelta;
     }
     double cH2O::Phi_r_deltatau(double delta, double tau)
     {
-        double sum1 = 0, sum2 = 0, sum3 = 0, sum4 = 0;
-        for (size_t i = 0; i < 7; i++)
-        {
-            sum1 += m_Table62.n[i] * m_Table62.d[i] * m_Table62.t[i] * pow(delta, m_Table62.d[i]-1.0) * pow(tau, m_Table62.t[i]-1.0);
-        }
-        for (size_t i = 7; i < 51; i++)
-        {
-            sum2 += m_Table62.n[i] * m_Table62.t[i] * pow(delta, m_Table62.d[i]-1.0) * pow(tau, m_Table62.t[i]-1.0) * (m_Table62.d[i] - m_Table62.c[i] * pow(delta, m_Table62.c[i])) * exp(-pow(delta,m_Table62.c[i]));
-        }
-        for (size_t i = 51; i < 54; i++)
-        {
-            sum3 += m_Table62.n[i] * pow(delta, m_Table62.d[i]) * pow(tau,m_Table62.t[i]) * exp(-m_Table62.alpha[i] * pow(delta - m_Table62.epsilon[i], 2.0) - m_Table62.beta[i] * pow(tau - m_Table62.gamma[i], 2.0)) * (m_Table62.d[i] / delta - 2 * m_Table62.alpha[i] * (delta - m_Table62.epsilon[i])) * (m_Table62.t[i] / tau - 2 * m_Table62.beta[i] * (tau - m_Table62.gamma[i]));
-        }
-        double psi = 0, theta = 0, Delta = 0, dpsiddelta = 0, dpsidtau=0, dDeltaddelta = 0, dDeltabiddelta = 0,dDeltabidtau=0, dDeltabidtauddelta=0,d2psidtauddelta=0,delta_minus_one_squre = 0, tau_minus_one_squre=0;
-        for (size_t i = 54; i < 56; i++)
-        {
-            delta_minus_one_squre = pow(delta - 1, 2.0);
-            tau_minus_one_squre = pow(tau - 1, 2.0);
-            psi = exp(-m_Table62.C[i]*delta_minus_one_squre - m_Table62.D[i]*tau_minus_one_squre);
-
-            theta = (1-tau) + m_Table62.A[i]*pow(delta_minus_one_squre, 0.5/m_Table62.beta[i]);
-
-            Delta = pow(theta, 2.0) + m_Table62.B[i]*pow(delta_minus_one_squre, m_Table62.a[i]);
-            dpsiddelta = -2*m_Table62.C[i]*(delta - 1) * psi;
-            dpsidtau = -2*m_Table62.D[i]*(tau - 1) * psi;
-            d2psidtauddelta = 4 * m_Table62.C[i] * psi * m_Table62.D[i] * (delta - 1) * (tau - 1);
-            dDeltaddelta = 2*(delta - 1)*(theta * m_Table62.A[i]/m_Table62.beta[i]*pow(delta_minus_one_squre, 0.5/m_Table62.beta[i] - 1) + m_Table62.B[i]*m_Table62.a[i]*pow(delta_minus_one_squre, m_Table62.a[i]-1));
-            // if(Delta == 0)
-            // {
-            //     dDeltabiddelta = 0;
-            // }else
-            // {
-                dDeltabiddelta = dDeltaddelta*m_Table62.b[i]*pow(Delta, m_Table62.b[i]-1);
-                dDeltabidtau = -2*theta*m_Table62.b[i]*pow(Delta, m_Table62.b[i]-1);
-                dDeltabidtauddelta = -m_Table62.A[i] * m_Table62.b[i] * 2 / m_Table62.beta[i] * pow(Delta, m_Table62.b[i]-1.0) * (delta - 1) * pow(pow(delta - 1, 2.0), 0.5/m_Table62.beta[i] - 1.0) - 2 * theta * m_Table62.b[i] * (m_Table62.b[i] - 1) * pow(Delta, m_Table62.b[i]-2.0) * dDeltaddelta;
-            // }
-            
-            sum4 += m_Table62.n[i]*(pow(Delta,m_Table62.b[i]) * (dpsidtau + delta * d2psidtauddelta) + delta * dDeltabiddelta * dpsidtau + dDeltabidtau * (psi + delta * dpsiddelta) + dDeltabidtauddelta * delta * psi);
-        }
-        
-        return sum1+sum2+sum3+sum4;
+        Phi_r_STRUCT phi_r;
+        Phi_r_all(delta, tau, phi_r);
+        return phi_r.phi_deltatau;
     }
     double cH2O::Phi_o(double delta, double tau)
     {
@@ -567,107 +524,132 @@ namespace H2O
         }
         return -m_Table61.n0[2]/pow(tau, 2.0) - sum;
     }
-    double cH2O::Phi_r(double delta, double tau)
+    void cH2O::Phi_r_all(double delta, double tau, Phi_r_STRUCT& phi_r)
     {
-        double sum1 = 0, sum2 = 0, sum3 = 0, sum4 = 0;
-        for (size_t i = 0; i < 7; i++)
-        {
-            sum1 += m_Table62.n[i] * pow(delta, m_Table62.d[i]) * pow(tau, m_Table62.t[i]);
-        }
-        for (size_t i = 7; i < 51; i++)
-        {
-            sum2 += m_Table62.n[i] * exp(-pow(delta,m_Table62.c[i])) * 
-                    pow(delta, m_Table62.d[i]) * pow(tau, m_Table62.t[i]);
-        }
+        const Table62_Terms& terms = m_Table62_Terms;
+        const int numTerms = Table62_Terms::numTerms;
+        // 1. power ladders: delta^k, tau^k (k = -1, ..., maxT, shifted by one) and tau^(k/8)
+        double delta_pow[Table62_Terms::maxD + 1], tau_pow[Table62_Terms::maxT + 2], tau_eighth_pow[8], exp_delta_c[Table62_Terms::maxC + 1];
+        delta_pow[0] = 1;
+        for (int k = 1; k <= Table62_Terms::maxD; k++)delta_pow[k] = delta_pow[k-1]*delta;
+        tau_pow[0] = 1.0/tau;
+        tau_pow[1] = 1;
+        for (int k = 2; k <= Table62_Terms::maxT + 1; k++)tau_pow[k] = tau_pow[k-1]*tau;
+        tau_eighth_pow[0] = 1;
+        tau_eighth_pow[4] = sqrt(tau);
+        tau_eighth_pow[2] = sqrt(tau_eighth_pow[4]);
+        tau_eighth_pow[1] = sqrt(tau_eighth_pow[2]);
+        tau_eighth_pow[3] = tau_eighth_pow[2]*tau_eighth_pow[1];
+        tau_eighth_pow[5] = tau_eighth_pow[4]*tau_eighth_pow[1];
+        tau_eighth_pow[6] = tau_eighth_pow[4]*tau_eighth_pow[2];
+        tau_eighth_pow[7] = tau_eighth_pow[4]*tau_eighth_pow[3];
+        exp_delta_c[0] = 1; // c_i = 0 for the first 7 terms, they have no exponential factor
+        for (int k = 1; k <= Table62_Terms::maxC; k++)exp_delta_c[k] = exp(-delta_pow[k]);
+        // 2. i = 1, ..., 51: n_i delta^d_i tau^t_i e^{-delta^c_i}, all derivatives are this term times a polynomial of d_i - c_i delta^c_i and t_i
+        double term[numTerms], c_delta_c[numTerms];
+        for (int i = 0; i < numTerms; i++)
+        {
+            term[i] = terms.n[i] * delta_pow[terms.d[i]] * tau_pow[terms.t_int[i] + 1] * tau_eighth_pow[terms.t_eighth[i]] * exp_delta_c[terms.c[i]];
+            c_delta_c[i] = terms.cc[i] * delta_pow[terms.c[i]];
+        }
+        double sum = 0, sum_d = 0, sum_dd = 0, sum_t = 0, sum_tt = 0, sum_dt = 0;
+        for (int i = 0; i < numTerms; i++)
+        {
+            double D = terms.dd[i] - c_delta_c[i];
+            sum += term[i];
+            sum_d += term[i] * D;
+            sum_dd += term[i] * (D*(D - 1) - terms.cc[i]*c_delta_c[i]);
+            sum_t += term[i] * terms.tt[i];
+            sum_tt += term[i] * terms.tt[i]*(terms.tt[i] - 1);
+            sum_dt += term[i] * D * terms.tt[i];
+        }
+        phi_r.phi = sum;
+        phi_r.phi_delta = sum_d/delta;
+        phi_r.phi_deltadelta = sum_dd/(delta*delta);
+        phi_r.phi_tau = sum_t/tau;
+        phi_r.phi_tautau = sum_tt/(tau*tau);
+        phi_r.phi_deltatau = sum_dt/(delta*tau);
+        // 3. i = 52, 53, 54: Gaussian bell-shaped terms
         for (size_t i = 51; i < 54; i++)
         {
-            sum3 += m_Table62.n[i] * pow(delta,m_Table62.d[i]) * pow(tau, m_Table62.t[i]) * exp(-m_Table62.alpha[i]*pow(delta - m_Table62.epsilon[i], 2.0) - m_Table62.beta[i]*pow(tau - m_Table62.gamma[i], 2.0) );
-        }
-        double psi = 0, theta = 0, Delta = 0, dpsidtau = 0, dDeltabidtau = 0, delta_minus_one_squre = 0;
+            double delta_eps = delta - m_Table62.epsilon[i], tau_gamma = tau - m_Table62.gamma[i];
+            double base = m_Table62.n[i] * delta_pow[(int)m_Table62.d[i]] * tau_pow[(int)m_Table62.t[i] + 1] * exp(-m_Table62.alpha[i]*delta_eps*delta_eps - m_Table62.beta[i]*tau_gamma*tau_gamma);
+            double Dd = m_Table62.d[i]/delta - 2*m_Table62.alpha[i]*delta_eps;
+            double Dt = m_Table62.t[i]/tau - 2*m_Table62.beta[i]*tau_gamma;
+            phi_r.phi += base;
+            phi_r.phi_delta += base * Dd;
+            phi_r.phi_deltadelta += base * (Dd*Dd - m_Table62.d[i]/(delta*delta) - 2*m_Table62.alpha[i]);
+            phi_r.phi_tau += base * Dt;
+            phi_r.phi_tautau += base * (Dt*Dt - m_Table62.t[i]/(tau*tau) - 2*m_Table62.beta[i]);
+            phi_r.phi_deltatau += base * Dd * Dt;
+        }
+        // 4. i = 55, 56: nonanalytical terms, each pow and exp is evaluated once and shared by all derivatives
+        double delta_minus_one = delta - 1, delta_minus_one_squre = delta_minus_one*delta_minus_one;
+        double tau_minus_one = tau - 1, tau_minus_one_squre = tau_minus_one*tau_minus_one;
         for (size_t i = 54; i < 56; i++)
         {
-            delta_minus_one_squre = pow(delta - 1, 2.0);
-            psi = exp(-m_Table62.C[i]*delta_minus_one_squre - m_Table62.D[i]*pow(tau - 1, 2.0));
-            theta = (1-tau) + m_Table62.A[i]*pow(delta_minus_one_squre, 0.5/m_Table62.beta[i]);
-            Delta = pow(theta, 2.0) + m_Table62.B[i]*pow(delta_minus_one_squre, m_Table62.a[i]);
-            sum4 += m_Table62.n[i]*delta*pow(Delta, m_Table62.b[i])*psi;
+            const double A = m_Table62.A[i], B = m_Table62.B[i], C = m_Table62.C[i], D = m_Table62.D[i], a = m_Table62.a[i], b = m_Table62.b[i], beta = m_Table62.beta[i];
+            double psi = exp(-C*delta_minus_one_squre - D*tau_minus_one_squre);
+            double pow_beta = pow(delta_minus_one_squre, 0.5/beta - 1); // [(delta-1)^2]^{1/(2beta)-1}
+            double pow_a = pow(delta_minus_one_squre, a - 1);           // [(delta-1)^2]^{a-1}
+            double theta = (1 - tau) + A*pow_beta*delta_minus_one_squre;
+            double Delta = theta*theta + B*pow_a*delta_minus_one_squre;
+            double Delta_b = pow(Delta, b);
+            double Delta_b1 = (Delta == 0 ? 0 : Delta_b/Delta);    // Delta^{b-1}
+            double Delta_b2 = (Delta == 0 ? 0 : Delta_b1/Delta);   // Delta^{b-2}
+
+            double dpsiddelta = -2*C*delta_minus_one*psi;
+            double dpsidtau = -2*D*tau_minus_one*psi;
+            double d2psiddelta2 = (2*C*delta_minus_one_squre - 1)*2*C*psi;
+            double d2psidtau2 = 2*D*psi*(2*D*tau_minus_one_squre - 1);
+            double d2psiddeltadtau = 4*C*D*delta_minus_one*tau_minus_one*psi;
+
+            double dDeltaddelta_over_delta_minus_one = 2*(theta*A/beta*pow_beta + B*a*pow_a);
+            double dDeltaddelta = delta_minus_one*dDeltaddelta_over_delta_minus_one;
+            double d2Deltaddelta2 = dDeltaddelta_over_delta_minus_one + 4*B*a*(a - 1)*pow_a + 2*A*A/(beta*beta)*pow_beta*pow_beta*delta_minus_one_squre + 4*A*theta/beta*(0.5/beta - 1)*pow_beta;
+
+            double dDeltabiddelta = b*Delta_b1*dDeltaddelta;
+            double d2Deltabiddelta2 = b*(Delta_b1*d2Deltaddelta2 + (b - 1)*Delta_b2*dDeltaddelta*dDeltaddelta);
+            double dDeltabidtau = -2*theta*b*Delta_b1;
+            double d2Deltabidtau2 = 2*b*Delta_b2*(Delta + 2*theta*theta*(b - 1));
+            double d2Deltabiddeltadtau = -A*b*2/beta*Delta_b1*delta_minus_one*pow_beta - 2*theta*b*(b - 1)*Delta_b2*dDeltaddelta;
+
+            const double n = m_Table62.n[i];
+            phi_r.phi += n*delta*Delta_b*psi;
+            phi_r.phi_delta += n*(Delta_b*(psi + delta*dpsiddelta) + dDeltabiddelta*delta*psi);
+            phi_r.phi_deltadelta += n*(Delta_b*(2*dpsiddelta + delta*d2psiddelta2) + 2*dDeltabiddelta*(psi + delta*dpsiddelta) + d2Deltabiddelta2*psi*delta);
+            phi_r.phi_tau += n*delta*(dDeltabidtau*psi + Delta_b*dpsidtau);
+            phi_r.phi_tautau += n*delta*(d2Deltabidtau2*psi + Delta_b*d2psidtau2 + 2*dDeltabidtau*dpsidtau);
+            phi_r.phi_deltatau += n*(Delta_b*(dpsidtau + delta*d2psiddeltadtau) + delta*dDeltabiddelta*dpsidtau + dDeltabidtau*(psi + delta*dpsiddelta) + d2Deltabiddeltadtau*delta*psi);
         }
-        
-        return sum1+sum2+sum3+sum4;
+    }
+    double cH2O::Phi_r(double delta, double tau)
+    {
+        Phi_r_STRUCT phi_r;
+        Phi_r_all(delta, tau, phi_r);
+        return phi_r.phi;
     }
     double cH2O::Phi_r_tau(double delta, double tau)
     {
-        double sum1 = 0, sum2 = 0, sum3 = 0, sum4 = 0;
-        for (size_t i = 0; i < 7; i++)
-        {
-            sum1 += m_Table62.n[i] * m_Table62.t[i] * pow(delta, m_Table62.d[i]) * pow(tau, m_Table62.t[i]-1.0);
-        }
-        for (size_t i = 7; i < 51; i++)
-        {
-            sum2 += m_Table62.n[i] * m_Table62.t[i] * exp(-pow(delta,m_Table62.c[i])) * 
-                    pow(delta, m_Table62.d[i]) * pow(tau, m_Table62.t[i]-1.0);
-        }
-        for (size_t i = 51; i < 54; i++)
-        {
-            sum3 += m_Table62.n[i] * pow(delta,m_Table62.d[i]) * pow(tau, m_Table62.t[i]) * exp(-m_Table62.alpha[i]*pow(delta - m_Table62.epsilon[i], 2.0) - m_Table62.beta[i]*pow(tau - m_Table62.gamma[i], 2.0) ) * (m_Table62.t[i]/tau - 2*m_Table62.beta[i]*(tau - m_Table62.gamma[i]) );
-        }
-        double psi = 0, theta = 0, Delta = 0, dpsidtau = 0, dDeltabidtau = 0, delta_minus_one_squre = 0;
-        for (size_t i = 54; i < 56; i++)
-        {
-            delta_minus_one_squre = pow(delta - 1, 2.0);
-            psi = exp(-m_Table62.C[i]*delta_minus_one_squre - m_Table62.D[i]*pow(tau - 1, 2.0));
-            theta = (1-tau) + m_Table62.A[i]*pow(delta_minus_one_squre, 0.5/m_Table62.beta[i]);
-            Delta = pow(theta, 2.0) + m_Table62.B[i]*pow(delta_minus_one_squre, m_Table62.a[i]);
-
-            dpsidtau = -2*m_Table62.D[i]*(tau - 1) * psi;
-            dDeltabidtau = -2*theta*m_Table62.b[i]*pow(Delta, m_Table62.b[i]-1);
-            
-            sum4 += m_Table62.n[i]*delta*(dDeltabidtau * psi + pow(Delta, m_Table62.b[i])*dpsidtau);
-        }
-        
-        return sum1+sum2+sum3+sum4;
+        Phi_r_STRUCT phi_r;
+        Phi_r_all(delta, tau, phi_r);
+        return phi_r.phi_tau;
     }
     double cH2O::Phi_r_tautau(double delta, double tau)
     {
-        double sum1 = 0, sum2 = 0, sum3 = 0, sum4 = 0;
-        for (size_t i = 0; i < 7; i++)
-        {
-            sum1 += m_Table62.n[i] * m_Table62.t[i] * (m_Table62.t[i] - 1.0) * pow(delta, m_Table62.d[i]) * pow(tau, m_Table62.t[i]-2.0);
-        }
-        for (size_t i = 7; i < 51; i++)
-        {
-            sum2 += m_Table62.n[i] * m_Table62.t[i] * (m_Table62.t[i] - 1.0) * exp(-pow(delta,m_Table62.c[i])) * 
-                    pow(delta, m_Table62.d[i]) * pow(tau, m_Table62.t[i]-2.0);
-        }
-        for (size_t i = 51; i < 54; i++)
-        {
-            sum3 += m_Table62.n[i] * pow(delta,m_Table62.d[i]) * pow(tau, m_Table62.t[i]) * exp(-m_Table62.alpha[i]*pow(delta - m_Table62.epsilon[i], 2.0) - m_Table62.beta[i]*pow(tau - m_Table62.gamma[i], 2.0) ) * (pow(m_Table62.t[i]/tau - 2*m_Table62.beta[i]*(tau - m_Table62.gamma[i]), 2.0) - m_Table62.t[i]/pow(tau,2.0) - 2.0*m_Table62.beta[i]);
-        }
-        double psi = 0, theta = 0, Delta = 0, dpsidtau = 0, dDeltabidtau = 0, d2psidtau2=0, d2Deltabidtau2=0, delta_minus_one_squre = 0, tau_minus_one_squre=0;
-        for (size_t i = 54; i < 56; i++)
-        {
-            delta_minus_one_squre = pow(delta - 1, 2.0);
-            tau_minus_one_squre = pow(tau - 1, 2.0);
-            psi = exp(-m_Table62.C[i]*delta_minus_one_squre - m_Table62.D[i]*tau_minus_one_squre);
-            theta = (1-tau) + m_Table62.A[i]*pow(delta_minus_one_squre, 0.5/m_Table62.beta[i]);
-            Delta = pow(theta, 2.0) + m_Table62.B[i]*pow(delta_minus_one_squre, m_Table62.a[i]);
-
-            dpsidtau = -2*m_Table62.D[i]*(tau - 1) * psi;
-            dDeltabidtau = -2*theta*m_Table62.b[i]*pow(Delta, m_Table62.b[i]-1);
-            d2psidtau2 = 2*m_Table62.D[i]*psi*(2*m_Table62.D[i]*tau_minus_one_squre - 1);
-            d2Deltabidtau2 = 2*m_Table62.b[i]*pow(Delta, m_Table62.b[i]-2) *(Delta + 2*theta*theta*(m_Table62.b[i] - 1));
-            sum4 += m_Table62.n[i]*delta*(d2Deltabidtau2 * psi + pow(Delta, m_Table62.b[i])*d2psidtau2 + 2*dDeltabidtau*dpsidtau);
-        }
-        
-        return sum1+sum2+sum3+sum4;
+        Phi_r_STRUCT phi_r;
+        Phi_r_all(delta, tau, phi_r);
+        return phi_r.phi_tautau;
     }
     double cH2O::SpecificEnthalpy_T_Rho(double T, double Rho)
     {
         double T_K = T + Kelvin;
         double delta = Rho/Rho_Critic;
         double tau = T_Critic_K/T_K;
+        Phi_r_STRUCT phi_r;
+        Phi_r_all(delta, tau, phi_r);
         // Note that, R_const in unit of kJ/kg/K
-        return R_const*T_K*(1 + tau*(Phi_o_tau(delta, tau) + Phi_r_tau(delta, tau)) + delta*Phi_r_delta(delta, tau) );
+        return R_const*T_K*(1 + tau*(Phi_o_tau(delta, tau) + phi_r.phi_tau) + delta*phi_r.phi_delta );
     }
     /**
      * \image html water_h.svg "Specific enthalpy of water calculated by swEOS" width=50%.
@@ -697,8 +679,10 @@ namespace H2O
         double T_K = T + Kelvin;
         double delta = Rho/Rho_Critic;
         double tau = T_Critic_K/T_K;
-        double Cv=Cv_T_Rho(T, Rho);
-        return Cv + R_const*pow(1+delta*Phi_r_delta(delta,tau) - delta*tau*Phi_r_deltatau(delta,tau), 2.0)/(1 + 2*delta*Phi_r_delta(delta,tau) + delta*delta*Phi_r_deltadelta(delta,tau));
+        Phi_r_STRUCT phi_r;
+        Phi_r_all(delta, tau, phi_r);
+        double Cv = (-tau*tau * (Phi_o_tautau(delta, tau) + phi_r.phi_tautau)) * R_const;
+        return Cv + R_const*pow(1+delta*phi_r.phi_delta - delta*tau*phi_r.phi_deltatau, 2.0)/(1 + 2*delta*phi_r.phi_delta + delta*delta*phi_r.phi_deltadelta);
     }
     /**
      * \image html water_cp.svg "Isobaric heat capacity of water calculated by swEOS" width=50%.
@@ -814,4 +798,41 @@ namespace H2O
         double rho2 = Rho(T2, P);
         return -1.0/rho * (rho - rho2)/(T - T2);
     }
+    void cH2O::State(double T, double P, WaterState& state)
+    {
+        double T_K = T + Kelvin;
+        double rho = Rho(T, P);
+        double delta = rho/Rho_Critic;
+        double tau = T_Critic_K/T_K;
+        Phi_r_STRUCT phi_r;
+        Phi_r_all(delta, tau, phi_r);
+        // dp/drho and dp/dT are in unit of R_const, i.e. kJ
+        double dp_drho = R_const*T_K*(1 + 2*delta*phi_r.phi_delta + delta*delta*phi_r.phi_deltadelta);
+        double dp_dT = rho*R_const*(1 + delta*phi_r.phi_delta - delta*tau*phi_r.phi_deltatau);
+        state.T = T;
+        state.P = P;
+        state.Rho = rho;
+        state.H = R_const*T_K*(1 + tau*(Phi_o_tau(delta, tau) + phi_r.phi_tau) + delta*phi_r.phi_delta);
+        state.Cv = (-tau*tau * (Phi_o_tautau(delta, tau) + phi_r.phi_tautau)) * R_const;
+        state.Cp = state.Cv + R_const*pow(1+delta*phi_r.phi_delta - delta*tau*phi_r.phi_deltatau, 2.0)/(1 + 2*delta*phi_r.phi_delta + delta*delta*phi_r.phi_deltadelta);
+        state.Mu = mu_T_Rho(T, rho);
+        state.beta = 1.0/(rho*dp_drho*1000);
+        state.alpha = dp_dT/(rho*dp_drho);
+    }
+    WaterState cH2O::State(double T, double P)
+    {
+        WaterState state;
+        State(T, P, state);
+        return state;
+    }
+    void cH2O::State(int num_points, const double* T, const double* P, WaterState* states)
+    {
+    #ifdef USE_OMP
+        #pragma omp parallel for shared(T, P, states)
+    #endif
+        for (int i = 0; i < num_points; i++)
+        {
+            State(T[i], P[i], states[i]);
+        }
+    }
 } // namespace H2O
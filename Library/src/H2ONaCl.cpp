@@ -11,16 +11,21 @@ namespace H2ONaCl
     // m_Tarray(NULL),
     // m_Xarray(NULL),
     // m_number(1),
-    m_Cr(init_Cr()),
-    m_f(init_f()),
+    m_Cr(shared_Cr()),
+    m_f(shared_f()),
     m_colorPrint(false),
+    m_tab4_Driesner2007a(shared_tab4_Driesner2007a()),
+    m_fast_region(false),
     m_num_threads(1),
     m_dim_lut(0),
-    m_pLUT(NULL)
+    m_pLUT(NULL),
+    m_lut_storage(LOOKUPTABLE_FOREST::LUT_STORAGE_TREE),
+    m_lut_vertex_cache(true),
+    m_lut_refine_level(true),
+    m_lut_props_layout(LOOKUPTABLE_FOREST::PROPS_LAYOUT_AOS)
     {
         // set_num_threads(omp_get_max_threads() > 8 ? 8 : 1);
         init_PhaseRegionName();
-        createTable4_Driesner2007a(m_tab4_Driesner2007a);
 
         // initialize supported properties index
         init_supported_props();
@@ -30,18 +35,180 @@ namespace H2ONaCl
         destroyLUT();
     }
     
+    /**
+     * @brief Evaluate the V+L+H pressure (eq. 10 of Driesner and Heinrich(2007)) and its derivative by Horner's scheme.
+     * 
+     * @param f Coefficients, f.f[10] is set
+     * @param x \f$ T/T_{triple, NaCl} \f$
+     * @param P [out] Pressure [bar]
+     * @param dPdx [out] \f$ dP/dx \f$
+     */
+    static void P_VLH_polynomial(const f_STRUCT& f, double x, double& P, double& dPdx)
+    {
+        P = f.f[10];
+        dPdx = 0;
+        for (int i = 9; i >= 0; i--)
+        {
+            dPdx = dPdx*x + P;
+            P = P*x + f.f[i];
+        }
+    }
     f_STRUCT cH2ONaCl:: init_f()
     {
         f_STRUCT f={
                     {4.64e-3, 5e-7, 1.69078e1, -2.69148e2, 7.63204e3, -4.95636e4, 2.33119e5, -5.13556e5, 5.49708e5, -2.84628e5, 0},
-                    0
+                    0, 0, 0
                 };
         for(int i=0;i<10;i++)
         {
             f.sum_f10+=f.f[i];
         }
+        f.f[10] = NaCl::P_Triple - f.sum_f10; //used to be set in findRegion for every call
+        // maximum of P_VLH: root of dP/dx in (TMIN_C, T_triple of NaCl], dP/dx is a constant polynomial, so its roots are only found once
+        const int degree = 9;
+        double coefficient[degree + 1], real_roots[degree], imag_roots[degree];
+        for (int i = 0; i < degree + 1; i++)coefficient[i] = (i + 1)*f.f[i + 1];
+        Polynomial polynomial;
+        polynomial.SetCoefficients(coefficient, degree);
+        int root_count = 0;
+        if (polynomial.FindRoots(real_roots, imag_roots, &root_count) == PolynomialRootFinder::SUCCESS)
+        {
+            for (int i = 0; i < root_count; ++i)
+            {
+                double root_T = real_roots[i]*NaCl::T_Triple;
+                if(imag_roots[i]==0 && root_T>H2ONaCl::TMIN_C && root_T<=NaCl::T_Triple)f.T_Pmax = root_T;
+            }
+        }
+        double dPdx;
+        P_VLH_polynomial(f, f.T_Pmax/NaCl::T_Triple, f.Pmax, dPdx);
         return f;    
     }
+    const f_STRUCT& cH2ONaCl::shared_f()
+    {
+        static const f_STRUCT f = init_f(); //initialization of a local static is thread-safe in C++11
+        return f;
+    }
+    /**
+     * @brief Cubic (4-point Lagrange) interpolation in interval i of a uniform table, the nodes i-1, i, i+1, i+2 are used.
+     * 
+     * @param nodes Values of the nodes, num_fields values per node
+     * @param i Index of the interval, i.e. the left node
+     * @param t Position in the interval, in [0, 1)
+     * @param values [out] num_fields interpolated values
+     */
+    static void interp_cubic_uniform(const double* nodes, int num_fields, int i, double t, double* values)
+    {
+        const double w[4] = {-t*(t - 1)*(t - 2)/6, (t + 1)*(t - 1)*(t - 2)/2, -(t + 1)*t*(t - 2)/2, (t + 1)*t*(t - 1)/6};
+        const double* node = nodes + (i - 1)*num_fields;
+        for (int k = 0; k < num_fields; k++)
+        {
+            values[k] = w[0]*node[k] + w[1]*node[num_fields + k] + w[2]*node[2*num_fields + k] + w[3]*node[3*num_fields + k];
+        }
+    }
+    /**
+     * @brief Interpolate a table of REGION_TABLES at x.
+     * 
+     * @return false if x is not in a valid interval
+     */
+    static bool interp_region_table(const double* nodes, const std::vector<char>& isValid, int num_fields, double x_min, double dx, double x, double* values)
+    {
+        double s = (x - x_min)/dx;
+        if(!(s >= 0 && s < isValid.size()))return false; //also NaN
+        int i = (int)s;
+        if(!isValid[i])return false;
+        interp_cubic_uniform(nodes, num_fields, i, s - i, values);
+        return true;
+    }
+    /**
+     * @brief Set the valid intervals of a table: the interpolation at 1/4, 1/2 and 3/4 of an interval must reproduce the exact values to a relative error of tol, 
+     * the first and the last interval and the intervals whose nodes cover a branch are not valid.
+     * 
+     * @param exact Exact values at x
+     */
+    static void validate_region_table(const double* nodes, std::vector<char>& isValid, int num_fields, double x_min, double dx, const std::vector<double>& x_branch, double tol,
+                                      const std::function<void(double x, double* values)>& exact)
+    {
+        const int num_intervals = (int)isValid.size();
+    #ifdef USE_OMP
+        #pragma omp parallel for schedule(dynamic, 64)
+    #endif
+        for (int i = 0; i < num_intervals; i++)
+        {
+            bool valid = (i > 0 && i < num_intervals - 1);
+            for (size_t b = 0; valid && b < x_branch.size(); b++)
+            {
+                if(x_branch[b] >= x_min + (i - 1)*dx && x_branch[b] <= x_min + (i + 2)*dx)valid = false;
+            }
+            std::vector<double> values_exact(num_fields), values_interp(num_fields);
+            for (int k = 1; valid && k < 4; k++)
+            {
+                exact(x_min + (i + k*0.25)*dx, values_exact.data());
+                interp_cubic_uniform(nodes, num_fields, i, k*0.25, values_interp.data());
+                for (int j = 0; j < num_fields; j++)
+                {
+                    if(!(fabs(values_interp[j] - values_exact[j]) <= tol*fabs(values_exact[j])))valid = false; //also NaN
+                }
+            }
+            isValid[i] = valid;
+        }
+    }
+    REGION_TABLES cH2ONaCl:: init_region_tables()
+    {
+        REGION_TABLES tables;
+        const double tol_interp = 1e-6; //relative error of the interpolated boundaries in a valid interval
+        tables.tol_boundary = 1e-5;
+        // 1. boundaries of findRegion in T, the branches of findRegion_boundaries_T are at the critical temperature of water (Driesner 2007), 500, 600 deg.C and the triple point of NaCl
+        const int num_fields = sizeof(REGION_BOUNDARY_T)/sizeof(double);
+        tables.T_min = 0;
+        tables.dT = 0.05;
+        const int num_T = (int)round((TMAX_C - tables.T_min)/tables.dT) + 3;
+        tables.boundary_T.resize(num_T);
+        tables.isValid_T.resize(num_T - 1);
+    #ifdef USE_OMP
+        #pragma omp parallel for schedule(dynamic, 64)
+    #endif
+        for (int i = 0; i < num_T; i++)
+        {
+            findRegion_boundaries_T(tables.T_min + i*tables.dT, tables.boundary_T[i]);
+        }
+        validate_region_table((const double*)tables.boundary_T.data(), tables.isValid_T, num_fields, tables.T_min, tables.dT, {373.976, 500, 600, NaCl::T_Triple}, tol_interp, 
+                              [this](double T, double* values){findRegion_boundaries_T(T, *(REGION_BOUNDARY_T*)values);});
+        // 2. boiling temperature of water in ln(P)
+        auto T_boiling = [this](double lnP, double* T_crit)
+        {
+            double temp1, temp2, temp3, temp4, temp5, temp6, temp7, temp8;
+            fluidProp_crit_P(exp(lnP)*1e5, 1e-10, *T_crit, temp1, temp2, temp3, temp4, temp5, temp6, temp7, temp8);
+        };
+        tables.lnP_min = log(1e-2);
+        tables.dlnP = 1e-3;
+        const int num_P = (int)round((log(2*PMAX) - tables.lnP_min)/tables.dlnP) + 3;
+        tables.T_crit_P.resize(num_P);
+        tables.isValid_P.resize(num_P - 1);
+    #ifdef USE_OMP
+        #pragma omp parallel for schedule(dynamic, 64)
+    #endif
+        for (int i = 0; i < num_P; i++)
+        {
+            T_boiling(tables.lnP_min + i*tables.dlnP, &tables.T_crit_P[i]);
+        }
+        validate_region_table(tables.T_crit_P.data(), tables.isValid_P, 1, tables.lnP_min, tables.dlnP, {}, tol_interp, T_boiling);
+        return tables;
+    }
+    const REGION_TABLES& cH2ONaCl::shared_region_tables()
+    {
+        static const REGION_TABLES tables = init_region_tables();
+        return tables;
+    }
+    const Cr_STRUCT& cH2ONaCl::shared_Cr()
+    {
+        static const Cr_STRUCT Cr = init_Cr();
+        return Cr;
+    }
+    const TABLE4& cH2ONaCl::shared_tab4_Driesner2007a()
+    {
+        static const TABLE4 tab4 = [](){TABLE4 table4; createTable4_Driesner2007a(table4); return table4;}();
+        return tab4;
+    }
     Cr_STRUCT cH2ONaCl:: init_Cr()
     {
         Cr_STRUCT Cr={
@@ -130,11 +297,21 @@ namespace H2ONaCl
         // H2ONaCl::PROP_H2ONaCl prop;
         prop.Region=SinglePhase_L;
         prop.T=0;
+        prop.P=0;
+        prop.X_wt=0;
         prop.H=0;
+        prop.Cp=0;
         prop.Rho=0;
+        prop.Mu=0;
         prop.Rho_l=0;
         prop.Rho_v=0;
         prop.Rho_h=0;
+        prop.H_l=0;
+        prop.H_v=0;
+        prop.H_h=0;
+        prop.Cp_l=0;
+        prop.Cp_v=0;
+        prop.Cp_h=0;
         prop.S_l=0;
         prop.S_v=0;
         prop.S_h=0;
@@ -142,6 +319,7 @@ namespace H2ONaCl
         prop.X_v=0;
         prop.Mu_l=0;
         prop.Mu_v=0;
+        prop.dRhodH=0;
     }
     ostream & operator << (ostream & out,  cH2ONaCl & A)
     {
@@ -203,242 +381,335 @@ namespace H2ONaCl
      */
     H2ONaCl::PROP_H2ONaCl cH2ONaCl:: prop_pHX(double p, double H, double X_wt)
     {
-        H2ONaCl::PROP_H2ONaCl prop;
-        init_prop(prop);
-        prop.P=p; prop.H=H; prop.X_wt=X_wt;
-        double T1, T2;
-        double tol=1e-4;
-        guess_T_PhX(p, H, X_wt, T1, T2);
-        // cout<<"T1: "<<T1<<" T2: "<<T2<<endl;
-        PROP_H2ONaCl prop1, prop2;
-        prop1=prop_pTX(p,T1+Kelvin,X_wt, false); 
-        prop2=prop_pTX(p,T2+Kelvin,X_wt, false); 
-        double h1 = prop1.H;
-        double h2 = prop2.H;
-        // printf("H: %f X_wt: %f T1: %f T2: %f h1: %f h2: %f\n",H,X_wt,T1,T2, h1, h2);
-        double h_l = prop2.H_l;
-        PROP_H2ONaCl prop22;
-        while(h2 < H)
-        {
-            T2 = T2 + 1;
-            prop22=prop_pTX(p,T2+Kelvin,X_wt, false);
-            h2 = prop22.H;
-            h_l = prop22.H_l;
-            if(h2<H && T2>1000) break;
-            if(X_wt==0) break;
-        }
-        
-        if (isnan(T2))
-        {
-            cout<<"error, T2->prop_pHX is nan: "<<T2<<endl;
-            exit(0);
-        }
-        if(h1>H)
-        {
-            T1=0;
-            prop1=prop_pTX(p,T1+Kelvin,X_wt, false); 
-            h1=prop1.H;
-        }
-        if((T2 > 1000 || h1 > H) || (h2 < H && T2 == 1000  && p >= 1.7e7) )
-        {
-            prop.Region=UnknownPhaseRegion;
-            prop.Rho=NAN;
-            prop.Rho_l=NAN;
-            prop.Rho_v=NAN;
-            prop.Rho_h=NAN;
-            prop.H=NAN;
-            prop.H_l=NAN;
-            prop.H_v=NAN;
-            prop.H_h=NAN;
-            prop.S_l=NAN;
-            prop.S_v=NAN;
-            prop.S_h=NAN;
-            prop.Mu=NAN;
-            prop.Mu_l=NAN;
-            prop.X_l=NAN;
-            prop.X_v=NAN;
-        }
-        else
+        return prop_pHX(p, H, X_wt, NAN);
+    }
+    double cH2ONaCl:: H_PhX_T(double p, double H, double X_wt, double& T_new, PROP_H2ONaCl& PROP_new)
+    {
+        PROP_new=prop_pTX(p,T_new+Kelvin,X_wt, false);
+        // enthalpy of pure water is not defined on (and very close to) the boiling curve, it is a L+V state
+        if(X_wt==0 && isnan(PROP_new.H)) PROP_new.Region = TwoPhase_L_V_X0;
+        // claculate new h in  L+V+H region 
+        calc_sat_lvh(PROP_new, H ,X_wt, false); 
+        switch (PROP_new.Region)
         {
-            
-            int iteri=0;
-            double T_new_mid=0;
-            //            double h_search=H;
-            bool ind_iter=true;
-            //            bool indmu=true;
-            while (ind_iter)
+        case ThreePhase_V_L_H:
             {
-                iteri = iteri +1;
-                // find new T with regular falsi method
-                double T_new=0;
-                if(T_new_mid == 0)
-                {
-                    //                    double dT = (H - h1) * (T2 - T1) / (h2-h1);
-                    T_new = T1 +  (H - h1) * (T2 - T1) / (h2-h1); 
-                    T_new_mid = 1;
-                }else
+                //could happen that S_l is negative, if h is outside of vlh region 
+                PROP_new.H = (PROP_new.S_l * PROP_new.Rho_l * PROP_new.H_l + 
+                            PROP_new.S_v * PROP_new.Rho_v * PROP_new.H_v +
+                            PROP_new.S_h * PROP_new.Rho_h * PROP_new.H_h) / PROP_new.Rho;
+                if(PROP_new.S_l < 0) //calc S_h and S_v 
                 {
-                    T_new = (T1 +  T2) / 2; 
-                    T_new_mid = 0; 
+                    PROP_new.S_h = (PROP_new.Rho_v * (PROP_new.X_v - X_wt))/(PROP_new.Rho_h * (X_wt-1) + PROP_new.Rho_v * (PROP_new.X_v - X_wt));
+                    PROP_new.S_v = 1 - PROP_new.S_h;  
+                    PROP_new.Rho = PROP_new.S_v * PROP_new.Rho_v + PROP_new.S_h * PROP_new.Rho_h ;
+                    PROP_new.H   = (PROP_new.S_v * PROP_new.Rho_v * PROP_new.H_v + PROP_new.S_h * PROP_new.Rho_h * PROP_new.H_h )/ PROP_new.Rho;
                 }
-                // claculate new h
-                PROP_H2ONaCl PROP_new=prop_pTX(p,T_new+Kelvin,X_wt, false);
-                if (isnan(T_new))
+                if(PROP_new.S_v<0) //calc S_h and S_l 
                 {
-                    printf("T_new is nan, T1: %f, T2: %f, H: %f, X:%f, h1: %f, h2: %f\n", T1, T2, H, X_wt, h1, h2);
-                    exit(0);
+                    PROP_new.S_h = (PROP_new.Rho_l*(PROP_new.X_l-X_wt))/(PROP_new.Rho_h*(X_wt-1) + PROP_new.Rho_l*(PROP_new.X_l-X_wt));
+                    PROP_new.S_l = 1 - PROP_new.S_h;  
+                    PROP_new.Rho = PROP_new.S_l * PROP_new.Rho_l + PROP_new.S_h * PROP_new.Rho_h ;
+                    PROP_new.H   = ( PROP_new.S_l * PROP_new.Rho_l * PROP_new.H_l + PROP_new.S_h * PROP_new.Rho_h * PROP_new.H_h )/ PROP_new.Rho;
                 }
-                // cout<<"new H: "<<PROP_new.H<<" region: "<<m_phaseRegion_name[PROP_new.Region]<<endl; exit(0);
-                // claculate new h in  L+V+H region 
-                calc_sat_lvh(PROP_new, H ,X_wt, false); 
-                switch (PROP_new.Region)
+                if(PROP_new.S_h<0) //calc S_l and S_v 
                 {
-                case ThreePhase_V_L_H:
-                    {
-                        //could happen that S_l is negative, if h is outside of vlh region 
-                        PROP_new.H = (PROP_new.S_l * PROP_new.Rho_l * PROP_new.H_l + 
-                                    PROP_new.S_v * PROP_new.Rho_v * PROP_new.H_v +
-                                    PROP_new.S_h * PROP_new.Rho_h * PROP_new.H_h) / PROP_new.Rho;
-                        if(PROP_new.S_l < 0) //calc S_h and S_v 
-                        {
-                            PROP_new.S_h = (PROP_new.Rho_v * (PROP_new.X_v - X_wt))/(PROP_new.Rho_h * (X_wt-1) + PROP_new.Rho_v * (PROP_new.X_v - X_wt));
-                            PROP_new.S_v = 1 - PROP_new.S_h;  
-                            PROP_new.Rho = PROP_new.S_v * PROP_new.Rho_v + PROP_new.S_h * PROP_new.Rho_h ;
-                            PROP_new.H   = (PROP_new.S_v * PROP_new.Rho_v * PROP_new.H_v + PROP_new.S_h * PROP_new.Rho_h * PROP_new.H_h )/ PROP_new.Rho;
-                        }
-                        if(PROP_new.S_v<0) //calc S_h and S_l 
-                        {
-                            PROP_new.S_h = (PROP_new.Rho_l*(PROP_new.X_l-X_wt))/(PROP_new.Rho_h*(X_wt-1) + PROP_new.Rho_l*(PROP_new.X_l-X_wt));
-                            PROP_new.S_l = 1 - PROP_new.S_h;  
-                            PROP_new.Rho = PROP_new.S_l * PROP_new.Rho_l + PROP_new.S_h * PROP_new.Rho_h ;
-                            PROP_new.H   = ( PROP_new.S_l * PROP_new.Rho_l * PROP_new.H_l + PROP_new.S_h * PROP_new.Rho_h * PROP_new.H_h )/ PROP_new.Rho;
-                        }
-                        if(PROP_new.S_h<0) //calc S_l and S_v 
-                        {
-                            PROP_new.S_l = (PROP_new.Rho_v*(PROP_new.X_v - X_wt))/(PROP_new.Rho_v*(PROP_new.X_v-X_wt)+ PROP_new.Rho_l*(X_wt-PROP_new.X_l)); 
-                            PROP_new.S_v = 1 - PROP_new.S_l;  
-                            PROP_new.Rho = PROP_new.S_l * PROP_new.Rho_l + PROP_new.S_v * PROP_new.Rho_v ;
-                            PROP_new.H   = ( PROP_new.S_l * PROP_new.Rho_l * PROP_new.H_l + PROP_new.S_v * PROP_new.Rho_v * PROP_new.H_v )/ PROP_new.Rho;                 
-                        }
-                    }
-                    break;
-                case TwoPhase_L_V_X0:
-                    {
-                        // this function has slightly different resutls than fluidprop_TP_Rho
-                        // for single pahse X = 0
-                        double T_crit, Rho_l, h_l, h_v, dpd_l0, dpd_v0, Rho_v, Mu_l0, Mu_v0;
-                        fluidProp_crit_P(p , 1e-12, T_crit, Rho_l, h_l, h_v, dpd_l0, dpd_v0, Rho_v, Mu_l0, Mu_v0);
-                        double S_l = (Rho_v*(h_v - H))/(Rho_v*(h_v-H) + Rho_l*(H-h_l)); 
-                        double S_v = 1- S_l;
-                        double Rho = S_l * Rho_l + S_v * Rho_v; 
-
-                        T_new = T_crit;
-                        PROP_new.H     = H;
-                        PROP_new.Rho   = Rho;
-                        PROP_new.Rho_l = Rho_l;
-                        PROP_new.Rho_v = Rho_v;
-                        PROP_new.H_l   = h_l;
-                        PROP_new.H_v   = h_v;
-                        PROP_new.S_l   = S_l;
-                        PROP_new.S_v   = S_v;
-                        if(S_l>1)
-                        {
-                            PROP_new.H    = h_l;
-                            PROP_new.S_l  = 1;
-                            PROP_new.S_v  = 0;
-                            PROP_new.Region  = SinglePhase_L;
-                            PROP_new.H_v  = 0;
-                            PROP_new.Rho_v= 0;
-                        }
-                        if(S_l<0)
-                        {
-                            PROP_new.H     = h_v;
-                            PROP_new.S_l   = 0;
-                            PROP_new.S_v   = 1;
-                            PROP_new.Region   = SinglePhase_V;
-                            PROP_new.H_l   = 0;
-                            PROP_new.Rho_l = 0;
-                        }
-        
-                    }
-                    break;
-                default:
-                    break;
+                    PROP_new.S_l = (PROP_new.Rho_v*(PROP_new.X_v - X_wt))/(PROP_new.Rho_v*(PROP_new.X_v-X_wt)+ PROP_new.Rho_l*(X_wt-PROP_new.X_l)); 
+                    PROP_new.S_v = 1 - PROP_new.S_l;  
+                    PROP_new.Rho = PROP_new.S_l * PROP_new.Rho_l + PROP_new.S_v * PROP_new.Rho_v ;
+                    PROP_new.H   = ( PROP_new.S_l * PROP_new.Rho_l * PROP_new.H_l + PROP_new.S_v * PROP_new.Rho_v * PROP_new.H_v )/ PROP_new.Rho;                 
                 }
-                if(X_wt==1)
+            }
+            break;
+        case TwoPhase_L_V_X0:
+            {
+                // this function has slightly different resutls than fluidprop_TP_Rho
+                // for single pahse X = 0
+                double T_crit, Rho_l, h_l, h_v, dpd_l0, dpd_v0, Rho_v, Mu_l0, Mu_v0;
+                fluidProp_crit_P(p , 1e-12, T_crit, Rho_l, h_l, h_v, dpd_l0, dpd_v0, Rho_v, Mu_l0, Mu_v0);
+                double S_l = (Rho_v*(h_v - H))/(Rho_v*(h_v-H) + Rho_l*(H-h_l)); 
+                double S_v = 1- S_l;
+                double Rho = S_l * Rho_l + S_v * Rho_v; 
+
+                T_new = T_crit;
+                PROP_new.H     = H;
+                PROP_new.Rho   = Rho;
+                PROP_new.Rho_l = Rho_l;
+                PROP_new.Rho_v = Rho_v;
+                PROP_new.H_l   = h_l;
+                PROP_new.H_v   = h_v;
+                PROP_new.S_l   = S_l;
+                PROP_new.S_v   = S_v;
+                if(S_l>1)
                 {
-                    double X_hal_liq, T_hm;
-                    calc_halit_liqidus(p, T_new,X_hal_liq, T_hm);  // T not important 
-                    if(T_new <= T_hm && T_new > (T_hm - 1e-4))
-                    {
-                        double Nenner = ( H * (PROP_new.Rho_l - PROP_new.Rho_h) - (PROP_new.H_l * PROP_new.Rho_l - PROP_new.H_h * PROP_new.Rho_h ) );
-                        double S_l_hm = PROP_new.Rho_h * (PROP_new.H_h - H)/ Nenner;
-                        double S_h_hm = 1 - S_l_hm;
-                        double Rho_hm = S_l_hm * PROP_new.Rho_l + (1-S_l_hm) * PROP_new.Rho_h;
-                        double h_hm = ( S_l_hm * PROP_new.Rho_l * PROP_new.H_l + S_h_hm * PROP_new.Rho_h * PROP_new.H_h )/Rho_hm;
-                        PROP_new.S_l  = S_l_hm; 
-                        PROP_new.S_h  = S_h_hm; 
-                        PROP_new.Rho  = Rho_hm; 
-                        PROP_new.H    = h_hm; 
-                    }
+                    PROP_new.H    = h_l;
+                    PROP_new.S_l  = 1;
+                    PROP_new.S_v  = 0;
+                    PROP_new.Region  = SinglePhase_L;
+                    PROP_new.H_v  = 0;
+                    PROP_new.Rho_v= 0;
                 }
-                if (isnan(T_new))
+                if(S_l<0)
                 {
-                    cout<<"error, T_new->prop_pHX is nan: "<<T_new<<endl;
-                    exit(0);
+                    PROP_new.H     = h_v;
+                    PROP_new.S_l   = 0;
+                    PROP_new.S_v   = 1;
+                    PROP_new.Region   = SinglePhase_V;
+                    PROP_new.H_l   = 0;
+                    PROP_new.Rho_l = 0;
                 }
-                
-                //  writing global storage
-                prop.Region = PROP_new.Region;
-                prop.T = T_new;
-                prop.H = PROP_new.H;
-                prop.Rho = PROP_new.Rho;
-                prop.Rho_l = PROP_new.Rho_l;
-                prop.Rho_v = PROP_new.Rho_v;
-                prop.Rho_h = PROP_new.Rho_h;
-                prop.H_l = PROP_new.H_l;
-                prop.H_v = PROP_new.H_v;
-                prop.H_h = PROP_new.H_h;
-                prop.S_l = PROP_new.S_l;
-                prop.S_v = PROP_new.S_v;
-                prop.S_h = PROP_new.S_h;
-                prop.X_l = PROP_new.X_l;
-                prop.X_v = PROP_new.X_v;
-
-                if(fabs(PROP_new.H - H)/H  < tol) ind_iter=false;
-                if(prop.H> H)
+
+            }
+            break;
+        default:
+            break;
+        }
+        if(X_wt==1)
+        {
+            double X_hal_liq, T_hm;
+            calc_halit_liqidus(p, T_new,X_hal_liq, T_hm);  // T not important 
+            if(T_new <= T_hm && T_new > (T_hm - 1e-4))
+            {
+                double Nenner = ( H * (PROP_new.Rho_l - PROP_new.Rho_h) - (PROP_new.H_l * PROP_new.Rho_l - PROP_new.H_h * PROP_new.Rho_h ) );
+                double S_l_hm = PROP_new.Rho_h * (PROP_new.H_h - H)/ Nenner;
+                double S_h_hm = 1 - S_l_hm;
+                double Rho_hm = S_l_hm * PROP_new.Rho_l + (1-S_l_hm) * PROP_new.Rho_h;
+                double h_hm = ( S_l_hm * PROP_new.Rho_l * PROP_new.H_l + S_h_hm * PROP_new.Rho_h * PROP_new.H_h )/Rho_hm;
+                PROP_new.S_l  = S_l_hm; 
+                PROP_new.S_h  = S_h_hm; 
+                PROP_new.Rho  = Rho_hm; 
+                PROP_new.H    = h_hm; 
+            }
+        }
+        return PROP_new.H;
+    }
+    H2ONaCl::PROP_H2ONaCl cH2ONaCl:: prop_pHX(double p, double H, double X_wt, double T_guess, PHX_SOLVE_INFO* info, int maxIter)
+    {
+        PHX_HINT hint = {T_guess, NAN, UnknownPhaseRegion};
+        return prop_pHX(p, H, X_wt, hint, info, maxIter);
+    }
+    void cH2ONaCl:: prop_pHX_batch(int num_points, const double* p, const double* H, const double* X_wt, PHX_HINT* hints, H2ONaCl::PROP_H2ONaCl* props, PHX_SOLVE_INFO* info)
+    {
+    #ifdef USE_OMP
+        #pragma omp parallel for shared(p, H, X_wt, hints, props, info)
+    #endif
+        for (int i = 0; i < num_points; i++)
+        {
+            if(hints)
+            {
+                props[i] = prop_pHX(p[i], H[i], X_wt[i], hints[i], info ? &info[i] : NULL);
+            }else
+            {
+                props[i] = prop_pHX(p[i], H[i], X_wt[i], NAN, info ? &info[i] : NULL);
+            }
+        }
+    }
+    /// Members of PROP_H2ONaCl in the order of PROP_COLUMN
+    static double PROP_H2ONaCl::* const PROP_COLUMN_MEMBERS[NUM_PROP_COLUMNS] = {&PROP_H2ONaCl::T, &PROP_H2ONaCl::P, &PROP_H2ONaCl::X_wt, &PROP_H2ONaCl::H, &PROP_H2ONaCl::Cp, &PROP_H2ONaCl::Rho, &PROP_H2ONaCl::Mu, 
+        &PROP_H2ONaCl::Rho_l, &PROP_H2ONaCl::Rho_v, &PROP_H2ONaCl::Rho_h, &PROP_H2ONaCl::H_l, &PROP_H2ONaCl::H_v, &PROP_H2ONaCl::H_h, &PROP_H2ONaCl::Cp_l, &PROP_H2ONaCl::Cp_v, &PROP_H2ONaCl::Cp_h, 
+        &PROP_H2ONaCl::S_l, &PROP_H2ONaCl::S_v, &PROP_H2ONaCl::S_h, &PROP_H2ONaCl::X_l, &PROP_H2ONaCl::X_v, &PROP_H2ONaCl::Mu_l, &PROP_H2ONaCl::Mu_v, &PROP_H2ONaCl::dRhodH};
+    static const char* const PROP_COLUMN_NAMES[NUM_PROP_COLUMNS] = {"T", "P", "X_wt", "H", "Cp", "Rho", "Mu", 
+        "Rho_l", "Rho_v", "Rho_h", "H_l", "H_v", "H_h", "Cp_l", "Cp_v", "Cp_h", 
+        "S_l", "S_v", "S_h", "X_l", "X_v", "Mu_l", "Mu_v", "dRhodH"};
+    string cH2ONaCl:: getPropColumnName(int column)
+    {
+        if(column < 0 || column >= NUM_PROP_COLUMNS)ERROR("Property column index out of range: "+to_string(column));
+        return PROP_COLUMN_NAMES[column];
+    }
+    void cH2ONaCl:: prop_columns(int num_points, const double* p, const double* TorH, const double* X_wt, LOOKUPTABLE_FOREST::EOS_ENERGY TorH_type, double** columns, H2ONaCl::PhaseRegion* phaseRegion)
+    {
+    #ifdef USE_OMP
+        #pragma omp parallel for schedule(dynamic, 64) shared(p, TorH, X_wt, columns, phaseRegion)
+    #endif
+        for (int i = 0; i < num_points; i++)
+        {
+            PROP_H2ONaCl prop = TorH_type == LOOKUPTABLE_FOREST::EOS_ENERGY_T ? prop_pTX(p[i], TorH[i], X_wt[i]) : prop_pHX(p[i], TorH[i], X_wt[i]);
+            for (int j = 0; j < NUM_PROP_COLUMNS; j++)
+            {
+                if(columns[j])columns[j][i] = prop.*PROP_COLUMN_MEMBERS[j];
+            }
+            if(phaseRegion)phaseRegion[i] = prop.Region;
+        }
+    }
+    /**
+     * @brief Mark a state which can not be calculated, e.g. prop_pHX does not find the temperature: the region is unknown and all properties except P and X_wt are NAN.
+     */
+    static void set_prop_unknown(H2ONaCl::PROP_H2ONaCl& prop)
+    {
+        prop.Region=UnknownPhaseRegion;
+        prop.T=NAN;
+        prop.H=NAN;
+        prop.Cp=NAN;
+        prop.Rho=NAN;
+        prop.Mu=NAN;
+        prop.Rho_l=NAN;
+        prop.Rho_v=NAN;
+        prop.Rho_h=NAN;
+        prop.H_l=NAN;
+        prop.H_v=NAN;
+        prop.H_h=NAN;
+        prop.Cp_l=NAN;
+        prop.Cp_v=NAN;
+        prop.Cp_h=NAN;
+        prop.S_l=NAN;
+        prop.S_v=NAN;
+        prop.S_h=NAN;
+        prop.X_l=NAN;
+        prop.X_v=NAN;
+        prop.Mu_l=NAN;
+        prop.Mu_v=NAN;
+        prop.dRhodH=NAN;
+    }
+    H2ONaCl::PROP_H2ONaCl cH2ONaCl:: prop_pHX(double p, double H, double X_wt, PHX_HINT& hint, PHX_SOLVE_INFO* info, int maxIter)
+    {
+        H2ONaCl::PROP_H2ONaCl prop;
+        init_prop(prop);
+        prop.P=p; prop.H=H; prop.X_wt=X_wt;
+        PHX_SOLVE_INFO solveInfo = {0, 0, false};
+        const double tol=1e-4;             // relative tolerance of enthalpy
+        const double tol_T=1e-10;          // absolute tolerance of temperature bracket [deg.C]
+        const double T_lower = 0, T_upper = TMAX_C;
+        double T1, T2, h1, h2;
+        PROP_H2ONaCl prop1, prop2;
+        double dT1 = 1, dT2 = 1; // first steps of the bracket expansion downward and upward
+        // 1. initial bracket, around the temperature of the hint if it is given, otherwise from the correlations of guess_T_PhX
+        if(!isnan(hint.T) && hint.T >= T_lower && hint.T <= T_upper)
+        {
+            T1 = hint.T;
+            h1 = H_PhX_T(p, H, X_wt, T1, prop1); solveInfo.num_eval++;
+            T2 = T1; h2 = h1; prop2 = prop1;
+            solveInfo.converged = (fabs(h1 - H) < tol*fabs(H));
+            // step to the other end of the bracket by the slope of the previous solution, 
+            // unless a phase boundary has been crossed or the previous state is on a temperature plateau (V+L+H, L+V at X=0)
+            if(prop1.Region == hint.Region && hint.dHdT > 0 && hint.Region != ThreePhase_V_L_H && hint.Region != TwoPhase_L_V_X0)
+            {
+                dT1 = max(1.02*fabs(H - h1)/hint.dHdT, 1E-6);
+                dT2 = dT1;
+            }
+        }else
+        {
+            guess_T_PhX(p, H, X_wt, T1, T2);
+            h1 = H_PhX_T(p, H, X_wt, T1, prop1);
+            h2 = H_PhX_T(p, H, X_wt, T2, prop2);
+            solveInfo.num_eval += 2;
+        }
+        // 2. expand the bracket exponentially until h1 <= H <= h2
+        while(!solveInfo.converged && !(h1 <= H) && T1 > T_lower)
+        {
+            if(!isnan(h1))
+            {
+                T2 = T1; h2 = h1; prop2 = prop1;
+            }
+            T1 = max(T1 - dT1, T_lower);
+            dT1 *= 2;
+            h1 = H_PhX_T(p, H, X_wt, T1, prop1); solveInfo.num_eval++;
+        }
+        while(!solveInfo.converged && !(h2 >= H) && T2 < T_upper)
+        {
+            if(!isnan(h2))
+            {
+                T1 = T2; h1 = h2; prop1 = prop2;
+            }
+            T2 = min(T2 + dT2, T_upper);
+            dT2 *= 2;
+            h2 = H_PhX_T(p, H, X_wt, T2, prop2); solveInfo.num_eval++;
+        }
+        if(!solveInfo.converged && (isnan(h1) || isnan(h2) || h1 > H || h2 < H))
+        {
+            set_prop_unknown(prop);
+            hint.T = NAN;
+            if(info)*info = solveInfo;
+            return prop;
+        }
+        // 3. Brent's method on f(T) = H(T) - H, b is the best estimate and [b, c] always brackets the root
+        PROP_H2ONaCl PROP_new = (fabs(h1 - H) < fabs(h2 - H) ? prop1 : prop2);
+        double T_new = (fabs(h1 - H) < fabs(h2 - H) ? T1 : T2);
+        double a = T1, b = T2, c = T2, fa = h1 - H, fb = h2 - H, fc = fb, d = b - a, e = d;
+        solveInfo.converged = solveInfo.converged || (fabs(fa) < tol*fabs(H) || fabs(fb) < tol*fabs(H));
+        double dHdT = (T2 != T1 ? (h2 - h1)/(T2 - T1) : hint.dHdT);
+        while (!solveInfo.converged && solveInfo.num_iter < maxIter)
+        {
+            if((fb > 0 && fc > 0) || (fb < 0 && fc < 0))
+            {
+                c = a; fc = fa; d = b - a; e = d;
+            }
+            if(fabs(fc) < fabs(fb))
+            {
+                a = b; b = c; c = a;
+                fa = fb; fb = fc; fc = fa;
+            }
+            double tol1 = 2*DBL_EPSILON*fabs(b) + 0.5*tol_T;
+            double xm = 0.5*(c - b);
+            if(fabs(xm) <= tol1)break; // bracket collapsed, e.g. enthalpy jumps at the boiling temperature
+            if(fabs(e) >= tol1 && fabs(fa) > fabs(fb))
+            {
+                // inverse quadratic interpolation, or secant if only two points are distinct
+                double s = fb/fa, P_, Q;
+                if(a == c)
                 {
-                    T2 = prop.T; 
-                    h2= prop.H;  
-                }
-                if(prop.H< H)
+                    P_ = 2*xm*s;
+                    Q = 1 - s;
+                }else
                 {
-                    T1=prop.T;
-                    h1=prop.H;
+                    double q = fa/fc, r = fb/fc;
+                    P_ = s*(2*xm*q*(q - r) - (b - a)*(r - 1));
+                    Q = (q - 1)*(r - 1)*(s - 1);
                 }
-                // what's this meaning ?????
-                //  T1( abs(PROP_new.h - h(ind_iter))./h(ind_iter)  < tol ) = [];  
-                // T2( abs(PROP_new.h - h(ind_iter))./h(ind_iter)  < tol ) = [];  
-                // h1( abs(PROP_new.h - h(ind_iter))./h(ind_iter)  < tol ) = [];  
-                // h2( abs(PROP_new.h - h(ind_iter))./h(ind_iter)  < tol ) = [];   
-                
-                // ind_iter( abs(PROP_new.h - h(ind_iter))./h(ind_iter)  < tol ) = []; 
-                if(iteri>=500)
+                if(P_ > 0) Q = -Q;
+                P_ = fabs(P_);
+                if(2*P_ < min(3*xm*Q - fabs(tol1*Q), fabs(e*Q)))
                 {
-                    ind_iter=false;
-                    break;
+                    e = d; d = P_/Q;
+                }else
+                {
+                    d = xm; e = d; //bisection
                 }
+            }else
+            {
+                d = xm; e = d; //bisection
             }
-            
-        }
-        if (isnan(prop.T))
-        {
-            cout<<"error, prop.T is nan in prop_pHX: "<<prop.T<<endl;
-            exit(0);
-        }
+            double b_old = b, fb_old = fb;
+            a = b; fa = fb;
+            b += (fabs(d) > tol1 ? d : (xm > 0 ? tol1 : -tol1));
+            T_new = b;
+            fb = H_PhX_T(p, H, X_wt, T_new, PROP_new) - H;
+            solveInfo.num_iter++;
+            solveInfo.num_eval++;
+            if (isnan(T_new) || isnan(fb))break; //the point is reported as unknown below, the same as a failed bracket search
+            b = T_new; //the temperature of L+V (X=0) state is set to the boiling temperature
+            if(b != b_old)dHdT = (fb - fb_old)/(b - b_old);
+            solveInfo.converged = (fabs(fb) < tol*fabs(H));
+        }
+        if (isnan(T_new) || isnan(fb))
+        {
+            solveInfo.converged = false;
+            set_prop_unknown(prop);
+            hint.T = NAN;
+            if(info)*info = solveInfo;
+            return prop;
+        }
+        //  writing global storage
+        prop.Region = PROP_new.Region;
+        prop.T = T_new;
+        prop.H = PROP_new.H;
+        prop.Rho = PROP_new.Rho;
+        prop.Rho_l = PROP_new.Rho_l;
+        prop.Rho_v = PROP_new.Rho_v;
+        prop.Rho_h = PROP_new.Rho_h;
+        prop.H_l = PROP_new.H_l;
+        prop.H_v = PROP_new.H_v;
+        prop.H_h = PROP_new.H_h;
+        prop.S_l = PROP_new.S_l;
+        prop.S_v = PROP_new.S_v;
+        prop.S_h = PROP_new.S_h;
+        prop.X_l = PROP_new.X_l;
+        prop.X_v = PROP_new.X_v;
         // calculate dynamic viscosity
         calcViscosity(prop.Region, p, prop.T, prop.X_l, prop.X_v, prop.Mu_l, prop.Mu_v);
-
+        hint.T = prop.T;
+        hint.Region = prop.Region;
+        hint.dHdT = dHdT;
+        if(info)*info = solveInfo;
         return prop;
     }
 
@@ -640,7 +911,7 @@ namespace H2ONaCl
         //---------------------------------------------------------
         double T=T_K-Kelvin,Xl_all,Xv_all;
         // 1. 
-        prop.Region=findRegion(T, p, Xwt2Xmol(X_wt), Xl_all,Xv_all);
+        prop.Region=findRegion_prop(T, p, Xwt2Xmol(X_wt), Xl_all,Xv_all);
         // printf("prop_pTX(p=%.2f bar, T=%E C, X=%E wt)->findRegion: %s\n",p/1E5, T, X_wt, m_phaseRegion_name[prop.Region].c_str());
         // 2. calculate rho
         // still problematic at high T & low P
@@ -719,7 +990,7 @@ namespace H2ONaCl
         prop.X_wt=X_wt;
         // 1. 
         double T=T_K-Kelvin,Xl_all,Xv_all;
-        prop.Region=findRegion(T, p, Xwt2Xmol(X_wt), Xl_all,Xv_all);
+        prop.Region=findRegion_prop(T, p, Xwt2Xmol(X_wt), Xl_all,Xv_all);
         // 2. calculate rho
         // still problematic at high T & low P
         double V_l_out, V_v_out, T_star_l_out, T_star_v_out, n1_v_out, n2_v_out;
@@ -769,7 +1040,7 @@ namespace H2ONaCl
         prop.X_wt=X_wt;
         // 1. 
         double T=T_K-Kelvin,Xl_all,Xv_all;
-        prop.Region=findRegion(T, p, Xwt2Xmol(X_wt), Xl_all,Xv_all);
+        prop.Region=findRegion_prop(T, p, Xwt2Xmol(X_wt), Xl_all,Xv_all);
         // 2. calculate rho
         // still problematic at high T & low P
         double V_l_out, V_v_out, T_star_l_out, T_star_v_out, n1_v_out, n2_v_out;
@@ -788,7 +1059,7 @@ namespace H2ONaCl
         prop.X_wt=X_wt;
         // 1. 
         double T=T_K-Kelvin,Xl_all,Xv_all;
-        prop.Region=findRegion(T, p, Xwt2Xmol(X_wt), Xl_all,Xv_all);
+        prop.Region=findRegion_prop(T, p, Xwt2Xmol(X_wt), Xl_all,Xv_all);
         // 4. 
         double Xw_l = Xl_all * NaCl::MolarMass / (Xl_all * NaCl::MolarMass + (1-Xl_all) * H2O::MolarMass);
         double Xw_v = Xv_all * NaCl::MolarMass / (Xv_all * NaCl::MolarMass + (1-Xv_all) * H2O::MolarMass);
@@ -807,7 +1078,7 @@ namespace H2ONaCl
         prop.X_wt=X_wt;
         // 1. 
         double T=T_K-Kelvin,Xl_all,Xv_all;
-        prop.Region=findRegion(T, p, Xwt2Xmol(X_wt), Xl_all,Xv_all);
+        prop.Region=findRegion_prop(T, p, Xwt2Xmol(X_wt), Xl_all,Xv_all);
         // 2. calculate rho
         // still problematic at high T & low P
         double V_l_out, V_v_out, T_star_l_out, T_star_v_out, n1_v_out, n2_v_out;
@@ -851,11 +1122,8 @@ namespace H2ONaCl
         
         return prop.Mu;
     }
-    PhaseRegion cH2ONaCl:: findRegion(const double T, const double P, const double X, double& Xl_all, double& Xv_all)
+    void cH2ONaCl:: findRegion_boundaries_T(const double T, REGION_BOUNDARY_T& bound)
     {
-        double Pres=P/1e5; //Pa -> bar
-        static_cast<void>(Xl_all=0), Xv_all=0;
-        PhaseRegion region_ind=SinglePhase_L;
         // CALCULATE CRITICAL P AND X FOR GIVEN T
         // First we need to find the Critical P and Critical X for the given T
         double cn1[7] = {-2.36, 1.28534e-1, -2.3707e-2, 3.20089e-3, -1.38917e-4, 1.02789e-7, -4.8376e-11};
@@ -940,11 +1208,8 @@ namespace H2ONaCl
         {
             cout<<"Fatal error in cH2ONaCl:: findRegion->logP_subboil, T: "<<T<<endl;
         }
-        double PNacl = pow(10,(logP_subboil)); // halite vapor pressure
-        // cout<<"logP_subboil: "<<logP_subboil<<" PNacl: "<<PNacl<<endl;exit(0);
 
-        // coeffs
-        m_f.f[10] = P_trip_salt - m_f.sum_f10;
+        // coeffs, m_f.f[10] = P_trip_salt - m_f.sum_f10 is set in init_f
         double T_star=0;
         if(T<=T_trip_salt)
         {
@@ -1017,35 +1282,6 @@ namespace H2ONaCl
 
         // cout<<"Xl_vlh: "<<Xl_vlh<<endl;exit(0);
 
-        // ======================================================================
-        // Calculate Xl_vh metastable for calulating Xv_vh at V - V+H transition P<P_vlh
-        double tol_P_LVH = 1e-6; 
-        bool ind=false;
-        double Xv_vh=0;
-        if(Pres < (P_vlh+tol_P_LVH))
-        {
-            ind=true;
-            // here Pres not P_lvh musst be used? 
-            double e2[6] = {0.0989944 + 3.30796e-6*Pres - 4.71759e-10*pow(Pres,2),
-                            0.00947257 - 8.66460e-6*Pres + 1.69417e-9*pow(Pres,2),
-                            0.610863 - 1.51716e-5*Pres + 1.19290e-8*pow(Pres,2),
-                            -1.64994 + 2.03441e-4*Pres - 6.46015e-8*pow(Pres,2),
-                            3.36474 - 1.54023e-4*Pres + 8.17048e-8*pow(Pres,2),
-                            1};
-            for(int i=0;i<5;i++)e2[5]-=e2[i]; 
-            double T_hm2 = T_trip_salt + a*(Pres - P_trip_salt);  // here Pres not P_lvh musst be used? 
-            double T_star2 = T/T_hm2;
-            double Xl_vh = (e2[0]*pow(T_star2,0)) + (e2[1]*pow(T_star2,1)) + (e2[2]*pow(T_star2,2))
-                        + (e2[3]*pow(T_star2,3)) + (e2[4]*pow(T_star2,4)) + (e2[5]*pow(T_star2,5));
-            // Calculate Xv_vh at V - V+H transition P<P_vlh  
-            double P_norm = (Pres - PNacl)/(P_crit - PNacl); // P_crit from equation 5a
-            double log10K2 = 1 + j0*(pow((1-P_norm),j1)) + j2*(1-P_norm) + j3*(pow((1-P_norm),2)) - (1+j0+j2+j3)*(pow((1-P_norm),3));  
-            double log10K1 = log10K2*(log10(PNacl/P_crit) - log10(Xl_vlh)) + log10(Xl_vlh); // here Xl_vlh must be used, not Xl_vh!?
-            double log10K = log10K1 - log10(PNacl/Pres);
-            double K_vh = pow(10,log10K);
-            Xv_vh = Xl_vh/K_vh;  
-        }
-        // cout<<" Xv_vh: "<<Xv_vh<<endl;exit(0);
         // ======================================================================
         // Calculate Xl_vl in V+L Region 
         double g1 = h2 + (h1-h2)/(1 + exp((T-h3)/h4)) + h5*(T*T);
@@ -1076,6 +1312,101 @@ namespace H2ONaCl
         // cout<<"X_crit: "<<X_crit<<endl;exit(0);
         double g0 = (Xl_vlh - X_crit - g1*(P_crit - P_vlh) - g2*pow((P_crit-P_vlh),2))/sqrt(P_crit-P_vlh);
         // cout<<"g0: "<<g0<<endl;
+        bound.P_crit = P_crit;
+        bound.X_crit = X_crit;
+        bound.logP_NaCl = logP_subboil;
+        bound.P_vlh = P_vlh;
+        bound.Xl_vlh = Xl_vlh;
+        bound.g0 = g0;
+        bound.g1 = g1;
+        bound.g2 = g2;
+        bound.j0 = j0;
+        bound.j1 = j1;
+        bound.j2 = j2;
+        bound.j3 = j3;
+    }
+    PhaseRegion cH2ONaCl:: findRegion(const double T, const double P, const double X, double& Xl_all, double& Xv_all)
+    {
+        double Pres=P/1e5; //Pa -> bar
+        REGION_BOUNDARY_T bound;
+        findRegion_boundaries_T(T, bound);
+        double temp1, temp2, temp3, temp4, temp5, temp6, temp7, temp8;
+        double T_crit=0;
+        fluidProp_crit_P( Pres*1e5 , 1e-10, T_crit, temp1, temp2, temp3, temp4, temp5, temp6, temp7, temp8);
+        // cout<<"T_crit: "<<T_crit<<endl;exit(0);
+        bool isNearBoundary;
+        return findRegion(bound, T_crit, T, P, X, Xl_all, Xv_all, 0, isNearBoundary);
+    }
+    PhaseRegion cH2ONaCl:: findRegion_fast(const double T, const double P, const double X, double& Xl_all, double& Xv_all, bool& isExact)
+    {
+        const REGION_TABLES& tables = shared_region_tables();
+        REGION_BOUNDARY_T bound;
+        double T_crit;
+        // L+V of pure water is only found within 1e-9 deg.C of the boiling curve, so X=0 always uses the exact path
+        if(X > 0 && interp_region_table((const double*)tables.boundary_T.data(), tables.isValid_T, sizeof(REGION_BOUNDARY_T)/sizeof(double), tables.T_min, tables.dT, T, (double*)&bound)
+                 && interp_region_table(tables.T_crit_P.data(), tables.isValid_P, 1, tables.lnP_min, tables.dlnP, log(P/1e5), &T_crit))
+        {
+            bool isNearBoundary;
+            PhaseRegion region_ind = findRegion(bound, T_crit, T, P, X, Xl_all, Xv_all, tables.tol_boundary, isNearBoundary);
+            if(!isNearBoundary)
+            {
+                isExact = false;
+                return region_ind;
+            }
+        }
+        isExact = true;
+        return findRegion(T, P, X, Xl_all, Xv_all);
+    }
+    PhaseRegion cH2ONaCl:: findRegion_prop(const double T, const double P, const double X, double& Xl_all, double& Xv_all)
+    {
+        if(!m_fast_region)return findRegion(T, P, X, Xl_all, Xv_all);
+        bool isExact;
+        return findRegion_fast(T, P, X, Xl_all, Xv_all, isExact);
+    }
+    PhaseRegion cH2ONaCl:: findRegion(const REGION_BOUNDARY_T& bound, const double T_crit, const double T, const double P, const double X, double& Xl_all, double& Xv_all, const double tol_boundary, bool& isNearBoundary)
+    {
+        double Pres=P/1e5; //Pa -> bar
+        static_cast<void>(Xl_all=0), Xv_all=0;
+        PhaseRegion region_ind=SinglePhase_L;
+        double Pcrit_h2o_point = 220.54915;
+        double a = 2.4726e-2;
+        double P_trip_salt = 5e-4;
+        double T_trip_salt = 800.7;
+        // temperature dependent boundaries, see findRegion_boundaries_T
+        const double P_crit = bound.P_crit, X_crit = bound.X_crit, P_vlh = bound.P_vlh, Xl_vlh = bound.Xl_vlh;
+        const double g0 = bound.g0, g1 = bound.g1, g2 = bound.g2;
+        const double j0 = bound.j0, j1 = bound.j1, j2 = bound.j2, j3 = bound.j3;
+        double PNacl = pow(10,(bound.logP_NaCl)); // halite vapor pressure
+
+        // ======================================================================
+        // Calculate Xl_vh metastable for calulating Xv_vh at V - V+H transition P<P_vlh
+        double tol_P_LVH = 1e-6; 
+        bool ind=false;
+        double Xv_vh=0;
+        if(Pres < (P_vlh+tol_P_LVH))
+        {
+            ind=true;
+            // here Pres not P_lvh musst be used? 
+            double e2[6] = {0.0989944 + 3.30796e-6*Pres - 4.71759e-10*pow(Pres,2),
+                            0.00947257 - 8.66460e-6*Pres + 1.69417e-9*pow(Pres,2),
+                            0.610863 - 1.51716e-5*Pres + 1.19290e-8*pow(Pres,2),
+                            -1.64994 + 2.03441e-4*Pres - 6.46015e-8*pow(Pres,2),
+                            3.36474 - 1.54023e-4*Pres + 8.17048e-8*pow(Pres,2),
+                            1};
+            for(int i=0;i<5;i++)e2[5]-=e2[i]; 
+            double T_hm2 = T_trip_salt + a*(Pres - P_trip_salt);  // here Pres not P_lvh musst be used? 
+            double T_star2 = T/T_hm2;
+            double Xl_vh = (e2[0]*pow(T_star2,0)) + (e2[1]*pow(T_star2,1)) + (e2[2]*pow(T_star2,2))
+                        + (e2[3]*pow(T_star2,3)) + (e2[4]*pow(T_star2,4)) + (e2[5]*pow(T_star2,5));
+            // Calculate Xv_vh at V - V+H transition P<P_vlh  
+            double P_norm = (Pres - PNacl)/(P_crit - PNacl); // P_crit from equation 5a
+            double log10K2 = 1 + j0*(pow((1-P_norm),j1)) + j2*(1-P_norm) + j3*(pow((1-P_norm),2)) - (1+j0+j2+j3)*(pow((1-P_norm),3));  
+            double log10K1 = log10K2*(log10(PNacl/P_crit) - log10(Xl_vlh)) + log10(Xl_vlh); // here Xl_vlh must be used, not Xl_vh!?
+            double log10K = log10K1 - log10(PNacl/Pres);
+            double K_vh = pow(10,log10K);
+            Xv_vh = Xl_vh/K_vh;  
+        }
+        // cout<<" Xv_vh: "<<Xv_vh<<endl;exit(0);
 
         // if (P_crit < Pres), than Xl_vl is complex. OpenFOAM will crash if calculate sqrt(negative value), IMPORTANT!!!
         double Xl_vl=0,Xv_vl=0;
@@ -1106,10 +1437,6 @@ namespace H2ONaCl
             P_crit_s=Pcrit_h2o_point; //P=22.141e6 T=375
         }
         // cout<<"P_crit_s: "<<P_crit_s<<endl;exit(0);
-        double temp1, temp2, temp3, temp4, temp5, temp6, temp7, temp8;
-        double T_crit=0;
-        fluidProp_crit_P( Pres*1e5 , 1e-10, T_crit, temp1, temp2, temp3, temp4, temp5, temp6, temp7, temp8);
-        // cout<<"T_crit: "<<T_crit<<endl;exit(0);
         double Xv = Xv_vl;
         if(ind)Xv = Xv_vh;
         if(Pres>=P_crit)Xv = 0;
@@ -1122,6 +1449,15 @@ namespace H2ONaCl
         // printf("Xv: %f\nXl: %f\nP_crit_s: %f\nT_crit: %f\nP_NaCl_vapor: %f\nNaCl::T_Triple: %f\nX_crit: %f\nP_vlh: %f\n\n",
         //         Xv, Xl, P_crit_s, T_crit, PNacl, T_trip_salt, X_crit, P_vlh);
 
+        // the boundaries of the accelerated classifier are interpolated, so a point close to any of them is classified by the exact path, see findRegion_fast
+        isNearBoundary = false;
+        if(tol_boundary > 0)
+        {
+            auto isNear = [tol_boundary](double v1, double v2){return fabs(v1 - v2) <= tol_boundary*(fabs(v1) + fabs(v2));};
+            isNearBoundary = isNear(Pres, P_crit) || isNear(Pres, PNacl) || isNear(Pres, P_vlh - tol_P_LVH) || isNear(Pres, P_vlh + tol_P_LVH)
+                            || isNear(T, T_crit) || isNear(X, Xv) || isNear(X, Xl) || isNear(X, X_crit);
+            if(isNearBoundary)return region_ind;
+        }
         if(X<Xv && Pres<=(P_crit_s) && T>=(T_crit) )region_ind  = SinglePhase_V;   // V  & Temp>=(T_crit)
         if(Pres<PNacl && T>T_trip_salt)region_ind = SinglePhase_V;   // V: below NaCl vapor pressure (for all NaCl values)
         if( X == 0 && Pres <= Pcrit_h2o_point && T<(T_crit+1e-9) && T>(T_crit-1e-9))region_ind = TwoPhase_L_V_X0;
@@ -1138,7 +1474,7 @@ namespace H2ONaCl
                     3.36474 - 1.54023e-4*Pres + 8.17048e-8*(Pres*Pres),
                     1};
         for(int i=0;i<5;i++)ee[5]-=ee[i];
-        T_hm = T_trip_salt + a*(Pres - P_trip_salt);  // melting temperature of halite pressure dependent
+        double T_hm = T_trip_salt + a*(Pres - P_trip_salt);  // melting temperature of halite pressure dependent
         double X_hal = (ee[0]*pow((T/T_hm),(1-1))) + (ee[1]*pow((T/T_hm),(2-1))) + (ee[2]*pow((T/T_hm),(3-1)))
         + (ee[3]*pow((T/T_hm),(4-1))) + (ee[4]*pow((T/T_hm),(5-1))) + (ee[5]*pow((T/T_hm),(6-1)));
 
@@ -2632,21 +2968,51 @@ namespace H2ONaCl
             }
         }
     }
+#ifdef USE_PROST
+    /**
+     * @brief PROST water state of the calling thread. The Prop structure is allocated once per thread rather than per evaluation, 
+     * and the state of the last evaluation is kept, so evaluating rho, h and mu at the same (p, T) only runs the PROST iteration once.
+     * 
+     */
+    struct WaterProp_PROST
+    {
+        Prop* prop;
+        double p, T_K; //state of prop, NAN means prop has not been evaluated
+        bool isMu;
+        double mu;
+        WaterProp_PROST():p(NAN),T_K(NAN),isMu(false),mu(0){prop = newProp('t', 'p', 1);}
+        ~WaterProp_PROST(){prop = freeProp(prop);}
+    };
+    static WaterProp_PROST& water_tp_thread(double p, double T_K)
+    {
+        static thread_local WaterProp_PROST water;
+        if(!(p == water.p && T_K == water.T_K))
+        {
+            // water_tp doesn't touch prop if (p, T) is invalid or saturated, so reset it as a newly created one, 
+            // otherwise the properties of the last state are returned rather than the zeros(NAN viscosity) as before
+            Prop* prop = water.prop;
+            prop->x = prop->T = prop->d = prop->p = prop->f = prop->g = 0.0;
+            prop->s = prop->u = prop->h = prop->cv = prop->cp = 0.0;
+            d_Prop* dprops[2] = {prop->dx, prop->dp};
+            for (int i = 0; i < 2; i++)
+            {
+                dprops[i]->T_Cd = dprops[i]->d_CT = 0.0;
+                dprops[i]->h_Cp = dprops[i]->p_Ch = 0.0;
+                dprops[i]->p_Cs = dprops[i]->s_Cp = 0.0;
+            }
+            double dp = 1.0e-8;
+            water_tp(T_K,p,0.0,dp,prop);
+            water.p = p;
+            water.T_K = T_K;
+            water.isMu = false;
+        }
+        return water;
+    }
+#endif
     double cH2ONaCl::water_rho_pT(double p, double T_K)
     {
         #ifdef USE_PROST
-            double d, dp, ds, dh;
-            Prop *prop0;
-            dp = 1.0e-8;
-            ds = 1.0e-8;
-            dh = 1.0e-8;
-            prop0 = newProp('t', 'p', 1);
-            d = 0.0;
-            water_tp(T_K,p,d,dp,prop0);
-            d=prop0->d;
-            // very very important!!!!
-            prop0 = freeProp(prop0);
-            return d;
+            return water_tp_thread(p, T_K).prop->d;
         #else 
             SteamState S = freesteam_set_pT(p, T_K);
             return freesteam_rho(S);
@@ -2656,18 +3022,7 @@ namespace H2ONaCl
     double cH2ONaCl::water_h_pT(double p, double T_K)
     {
         #ifdef USE_PROST
-            double d, dp, ds, dh;
-            Prop *prop0;
-            dp = 1.0e-8;
-            ds = 1.0e-8;
-            dh = 1.0e-8;
-            prop0 = newProp('t', 'p', 1);
-            d = 0.0;
-            water_tp(T_K,p,d,dp,prop0);
-            double h=prop0->h;
-            // very very important!!!!
-            prop0 = freeProp(prop0);
-            return h;
+            return water_tp_thread(p, T_K).prop->h;
         #else 
             SteamState S = freesteam_set_pT(p, T_K);
             return freesteam_h(S);
@@ -2676,18 +3031,13 @@ namespace H2ONaCl
     double cH2ONaCl::water_mu_pT(double p, double T_K)
     {
         #ifdef USE_PROST
-            double d, dp, ds, dh;
-            Prop *prop0;
-            dp = 1.0e-8;
-            ds = 1.0e-8;
-            dh = 1.0e-8;
-            prop0 = newProp('t', 'p', 1);
-            d = 0.0;
-            water_tp(T_K,p,d,dp,prop0);
-            double mu=viscos(prop0);
-            // very very important!!!!
-            prop0 = freeProp(prop0);
-            return mu;
+            WaterProp_PROST& water = water_tp_thread(p, T_K);
+            if(!water.isMu)
+            {
+                water.mu = viscos(water.prop);
+                water.isMu = true;
+            }
+            return water.mu;
         #else 
             SteamState S = freesteam_set_pT(p, T_K);
             return freesteam_mu(S);
@@ -3153,44 +3503,8 @@ namespace H2ONaCl
     }
     void cH2ONaCl::Pmax_VaporLiquidHaliteCoexist(double& T, double& P)
     {
-        // Table 6 of Driesner and Heinrich(2007)
-        double f[11] = {0.00464, 5E-07, 16.9078, -269.148, 7632.04, -49563.6, 233119.0, -513556.0, 549708.0, -284628.0, NaCl::P_Triple};
-        for (size_t i = 0; i < 10; i++) //calculate P_VLH (eq. 10) and f[10] simultaneously
-        {
-            f[10] -= f[i];
-        }
-        // find root
-        const int degree = 9;
-        Polynomial polynomial;
-        std::vector<double> coefficient_vector;
-        coefficient_vector.resize(degree + 1);
-        double * coefficient_vector_ptr = &coefficient_vector[0];
-        for (size_t i = 0; i < degree+1; i++)
-        {
-            coefficient_vector_ptr[i]=(i+1)*f[i+1];
-        }
-        polynomial.SetCoefficients(coefficient_vector_ptr, degree);
-
-        std::vector<double> real_vector;
-        std::vector<double> imag_vector;
-        real_vector.resize(degree);
-        imag_vector.resize(degree);
-        double * real_vector_ptr = &real_vector[0];
-        double * imag_vector_ptr = &imag_vector[0];
-        int root_count= 0;
-        if (polynomial.FindRoots(real_vector_ptr,imag_vector_ptr,&root_count) == PolynomialRootFinder::SUCCESS)
-        {
-            for (int i = 0; i < root_count; ++i)
-            {
-                if(imag_vector_ptr[i]==0)
-                {
-                    double root_T = real_vector_ptr[i]*NaCl::T_Triple;
-                    if(root_T>H2ONaCl::TMIN_C && root_T<=NaCl::T_Triple)
-                    T=root_T;
-                }
-            }
-        }
-        P = P_VaporLiquidHaliteCoexist(T);
+        T = m_f.T_Pmax;
+        P = m_f.Pmax;
     }
     std::vector<double> cH2ONaCl::HX_VaporLiquidHaliteCoexist(double P)
     {
@@ -3251,47 +3565,36 @@ namespace H2ONaCl
     }
     std::vector<double> cH2ONaCl::T_VaporLiquidHaliteCoexist(double P)
     {
-        // Table 6 of Driesner and Heinrich(2007)
-        // P = f0 + f1*x + f2*x^2 + ... + f10*x^{10} ==>
-        // f(x)=f0 - P + f1*x + f2*x^2 + ... + f10*x^{10} = 0, where x=T/T_{triple, NaCl}
-        const int degree = 10;
-        double f[11] = {0.00464, 5E-07, 16.9078, -269.148, 7632.04, -49563.6, 233119.0, -513556.0, 549708.0, -284628.0, NaCl::P_Triple};
-        for (size_t i = 0; i < 10; i++) 
-        {
-            f[10] -= f[i];
-        }
-        Polynomial polynomial;
-        std::vector<double> coefficient_vector;
-        coefficient_vector.resize(degree + 1);
-        double * coefficient_vector_ptr = &coefficient_vector[0];
-        for (size_t i = 0; i < degree+1; i++)
-        {
-            coefficient_vector_ptr[i]=f[i];
-        }
-        coefficient_vector_ptr[0]=coefficient_vector_ptr[0]-P;
-        polynomial.SetCoefficients(coefficient_vector_ptr, degree);
-
-        std::vector<double> real_vector;
-        std::vector<double> imag_vector;
-        real_vector.resize(degree);
-        imag_vector.resize(degree);
-        double * real_vector_ptr = &real_vector[0];
-        double * imag_vector_ptr = &imag_vector[0];
-        int root_count= 0;
+        // P_VLH (eq. 10 of Driesner and Heinrich(2007)) increases in [TMIN_C, T_Pmax] and decreases in [T_Pmax, TMAX_C], 
+        // so each branch has at most one root. It is solved by Newton iteration in x=T/T_{triple, NaCl}, kept in the bracket by bisection steps.
         std::vector<double> roots_T;
-        if (polynomial.FindRoots(real_vector_ptr,imag_vector_ptr,&root_count) == PolynomialRootFinder::SUCCESS)
-        {
-            for (int i = 0; i < root_count; ++i)
+        const double x_branch[3] = {H2ONaCl::TMIN_C/NaCl::T_Triple, m_f.T_Pmax/NaCl::T_Triple, H2ONaCl::TMAX_C/NaCl::T_Triple};
+        double P_x, dPdx;
+        for (int branch = 0; branch < 2; branch++)
+        {
+            double x_lo = x_branch[branch], x_hi = x_branch[branch + 1];
+            P_VLH_polynomial(m_f, x_lo, P_x, dPdx);
+            double res_lo = P_x - P;
+            P_VLH_polynomial(m_f, x_hi, P_x, dPdx);
+            double res_hi = P_x - P;
+            if(res_lo*res_hi > 0)continue;
+            if(branch == 1 && res_lo == 0)continue; //P == Pmax, the shared endpoint is already the root of the first branch
+            double x = (res_lo == 0 ? x_lo : (res_hi == 0 ? x_hi : 0.5*(x_lo + x_hi)));
+            for (int iter = 0; iter < 200 && res_lo*res_hi != 0; iter++)
             {
-                if(imag_vector_ptr[i]==0)
-                {
-                    double root_T = real_vector_ptr[i]*NaCl::T_Triple;
-                    if(root_T>=H2ONaCl::TMIN_C && root_T<=H2ONaCl::TMAX_C)
-                    roots_T.push_back(root_T);
-                }
+                P_VLH_polynomial(m_f, x, P_x, dPdx);
+                double res = P_x - P;
+                if(res == 0)break;
+                if((res < 0) == (res_lo < 0))x_lo = x;
+                else x_hi = x;
+                double x_new = x - res/dPdx;
+                if(!(x_new > x_lo && x_new < x_hi))x_new = 0.5*(x_lo + x_hi);
+                bool isConverged = fabs(x_new - x) <= 1E-15*x;
+                x = x_new;
+                if(isConverged)break;
             }
+            roots_T.push_back(x*NaCl::T_Triple);
         }
-        
         return roots_T;
     }
     /**
@@ -4052,14 +4355,40 @@ namespace H2ONaCl
     }
     PhaseRegion cH2ONaCl::findPhaseRegion(const double T_c, const double P_bar, const double X_wt)
     {
+        if(m_fast_region)return findPhaseRegion_fast(T_c, P_bar, X_wt);
         double Xl_all, Xv_all;
         return findRegion(T_c, P_bar*1E5, Xwt2Xmol(X_wt), Xl_all, Xv_all);
     }
     PhaseRegion cH2ONaCl::findPhaseRegion_pTX(double p_Pa, double T_K, double X_wt)
     {
+        if(m_fast_region)return findPhaseRegion_fast(T_K - 273.15, p_Pa/1E5, X_wt);
         double Xl_all, Xv_all;
         return findRegion(T_K - 273.15, p_Pa, Xwt2Xmol(X_wt), Xl_all, Xv_all);
     }
+    PhaseRegion cH2ONaCl::findPhaseRegion_fast(const double T_c, const double P_bar, const double X_wt)
+    {
+        double Xl_all, Xv_all;
+        bool isExact;
+        return findRegion_fast(T_c, P_bar*1E5, Xwt2Xmol(X_wt), Xl_all, Xv_all, isExact);
+    }
+    double cH2ONaCl::agreement_findPhaseRegion_fast(int num_points, const double* T_c, const double* P_bar, const double* X_wt, int& num_exact)
+    {
+        shared_region_tables(); //build the tables before the parallel loop
+        int num_agree = 0, num_exact_all = 0;
+    #ifdef USE_OMP
+        #pragma omp parallel for schedule(dynamic, 256) reduction(+:num_agree, num_exact_all)
+    #endif
+        for (int i = 0; i < num_points; i++)
+        {
+            double Xl_all, Xv_all, Xl_fast, Xv_fast;
+            bool isExact;
+            const double X = Xwt2Xmol(X_wt[i]);
+            if(findRegion_fast(T_c[i], P_bar[i]*1E5, X, Xl_fast, Xv_fast, isExact) == findRegion(T_c[i], P_bar[i]*1E5, X, Xl_all, Xv_all))num_agree++;
+            if(isExact)num_exact_all++;
+        }
+        num_exact = num_exact_all;
+        return num_points > 0 ? num_agree/(double)num_points : 1;
+    }
     void cH2ONaCl::writePhaseSurface_XHP(double scale_X, double scale_H, double scale_P, string outpath, H2ONaCl::fmtOutPutFile fmt, int nP)
     {
         double Pmin = PMIN; // bar
@@ -4407,7 +4736,7 @@ namespace H2ONaCl
         
         destroyLUT(); //destroy lut pointer and release all data before create a new one.
         // WAIT("destroyLUT");
-        clock_t start = clock();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
         STATUS("Creating 2D lookup table ...");
         // const int dim =2;
         m_dim_lut = 2;
@@ -4416,43 +4745,21 @@ namespace H2ONaCl
         // WAIT("new LookUpTableForest_2D");
         // refine
         tmp_lut_2D->set_min_level(min_level);
+        if(m_lut_storage != LOOKUPTABLE_FOREST::LUT_STORAGE_TREE)tmp_lut_2D->linearize();
+        if(m_lut_vertex_cache)tmp_lut_2D->enable_vertex_cache(sizeof(PROP_H2ONaCl));
+        tmp_lut_2D->set_props_layout(m_lut_props_layout);
         // tmp_lut_2D->refine(refine_uniform);
         // WAIT("refine_uniform");
         // parallel refine
         if (tmp_lut_2D->m_TorH == LOOKUPTABLE_FOREST::EOS_ENERGY_T)
         {
-        #ifdef USE_OMP
-            #pragma omp parallel //shared(n)
-        #endif
-            {
-            #ifdef USE_OMP
-                #pragma omp single
-            #endif
-                {
-                    printf("Do refinement using %d threads.\n", m_num_threads);
-                    tmp_lut_2D->refine(RefineFunc_PTX);
-                }
-            }
-            // update properties data on leaves
-            STATUS_time("Lookup table refinement done", (clock() - start)/m_num_threads);
+            refine_LUT(tmp_lut_2D, RefineFunc_PTX, m_lut_refine_level, m_num_threads);
+            STATUS_system_time("Lookup table refinement done", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
             tmp_lut_2D->construct_props_leaves(cal_prop_PTX);
         }else if(tmp_lut_2D->m_TorH == LOOKUPTABLE_FOREST::EOS_ENERGY_H)
         {
-        #ifdef USE_OMP
-            #pragma omp parallel //shared(n)
-        #endif
-            {
-            #ifdef USE_OMP
-                #pragma omp single
-            #endif
-                {
-                    printf("Do refinement using %d threads.\n", m_num_threads);
-                    tmp_lut_2D->refine(RefineFunc_PHX);
-                }
-            }
-
-            // 
-            STATUS_time("Lookup table refinement done", (clock() - start)/m_num_threads);
+            refine_LUT(tmp_lut_2D, RefineFunc_PHX, m_lut_refine_level, m_num_threads);
+            STATUS_system_time("Lookup table refinement done", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
             tmp_lut_2D->construct_props_leaves(cal_prop_PHX);
         }else
         {
@@ -4470,48 +4777,27 @@ namespace H2ONaCl
         parse_update_which_props(update_which_props);
 
         destroyLUT(); //destroy LUT pointer and release all related data if it exists.
-        clock_t start = clock();
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
         STATUS("Creating 3D lookup table ...");
         m_dim_lut = 3;
         LookUpTableForest_3D* tmp_lut_3D = new LookUpTableForest_3D (xyz_min, xyz_max, TorH, max_level, m_update_which_props, this);
         m_pLUT = tmp_lut_3D;
         // refine
         tmp_lut_3D->set_min_level(min_level);
+        if(m_lut_storage != LOOKUPTABLE_FOREST::LUT_STORAGE_TREE)tmp_lut_3D->linearize();
+        if(m_lut_vertex_cache)tmp_lut_3D->enable_vertex_cache(sizeof(PROP_H2ONaCl));
+        tmp_lut_3D->set_props_layout(m_lut_props_layout);
         tmp_lut_3D->refine(refine_uniform);
         // parallel refine
         if(tmp_lut_3D->m_TorH == LOOKUPTABLE_FOREST::EOS_ENERGY_T)
         {
-        #ifdef USE_OMP
-            #pragma omp parallel //shared(n)
-        #endif
-            {
-            #ifdef USE_OMP
-                #pragma omp single
-            #endif
-                {
-                    printf("Do refinement using %d threads.\n", m_num_threads);
-                    tmp_lut_3D->refine(RefineFunc_PTX);
-                }
-            }
-            // 
-            STATUS_time("Lookup table refinement done", (clock() - start)/m_num_threads);
+            refine_LUT(tmp_lut_3D, RefineFunc_PTX, m_lut_refine_level, m_num_threads);
+            STATUS_system_time("Lookup table refinement done", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
             tmp_lut_3D->construct_props_leaves(cal_prop_PTX);
         }else if (tmp_lut_3D->m_TorH == LOOKUPTABLE_FOREST::EOS_ENERGY_H)
         {
-        #ifdef USE_OMP
-            #pragma omp parallel //shared(n)
-        #endif
-            {
-            #ifdef USE_OMP
-                #pragma omp single
-            #endif
-                {
-                    printf("Do refinement using %d threads.\n", m_num_threads);
-                    tmp_lut_3D->refine(RefineFunc_PHX);
-                }
-            }
-            // 
-            STATUS_time("Lookup table refinement done", (clock() - start)/m_num_threads);
+            refine_LUT(tmp_lut_3D, RefineFunc_PHX, m_lut_refine_level, m_num_threads);
+            STATUS_system_time("Lookup table refinement done", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
             tmp_lut_3D->construct_props_leaves(cal_prop_PHX);
         }else
         {
@@ -4529,6 +4815,24 @@ namespace H2ONaCl
         }
     }
 
+    void cH2ONaCl::save_lut_to_vtu(string filename, LOOKUPTABLE_FOREST::VTU_FORMAT format, bool compress)
+    {
+        if(m_pLUT)
+        {
+            if(m_dim_lut==2)((LookUpTableForest_2D*)m_pLUT)->write_to_vtu(filename, format, compress);
+            else ((LookUpTableForest_3D*)m_pLUT)->write_to_vtu(filename, format, compress);
+        }
+    }
+
+    void cH2ONaCl::save_lut_to_pvtu(string filename, int num_pieces, LOOKUPTABLE_FOREST::VTU_FORMAT format, bool compress)
+    {
+        if(m_pLUT)
+        {
+            if(m_dim_lut==2)((LookUpTableForest_2D*)m_pLUT)->write_to_pvtu(filename, num_pieces, format, compress);
+            else ((LookUpTableForest_3D*)m_pLUT)->write_to_pvtu(filename, num_pieces, format, compress);
+        }
+    }
+
     void cH2ONaCl::save_lut_to_binary(string filename)
     {
         if(m_pLUT)
@@ -4538,6 +4842,15 @@ namespace H2ONaCl
         }
     }
 
+    void cH2ONaCl::save_lut_to_single_binary(string filename)
+    {
+        if(m_pLUT)
+        {
+            if(m_dim_lut==2)((LookUpTableForest_2D*)m_pLUT)->write_to_single_binary(filename);
+            else ((LookUpTableForest_3D*)m_pLUT)->write_to_single_binary(filename);
+        }
+    }
+
     void cH2ONaCl::destroyLUT()
     {
         if(m_pLUT)
@@ -4571,7 +4884,7 @@ namespace H2ONaCl
     }
 
     template<int dim>
-    void cH2ONaCl::interp_quad_prop(LOOKUPTABLE_FOREST::Quadrant<dim,H2ONaCl::FIELD_DATA<dim> > *targetLeaf, double* xyz_min_target, H2ONaCl::PROP_H2ONaCl& prop, const double xyz[dim])
+    void cH2ONaCl::interp_quad_prop(LOOKUPTABLE_FOREST::LeafRef<dim,H2ONaCl::FIELD_DATA<dim> >& targetLeaf, double* xyz_min_target, H2ONaCl::PROP_H2ONaCl& prop, const double xyz[dim])
     {
         LOOKUPTABLE_FOREST::LookUpTableForest<dim, H2ONaCl::FIELD_DATA<dim> >* tmp_lut = (LOOKUPTABLE_FOREST::LookUpTableForest<dim, H2ONaCl::FIELD_DATA<dim> >*)m_pLUT;
         // double physical_length[dim]; //physical length of the quad
@@ -4582,60 +4895,212 @@ namespace H2ONaCl
         // get_coeff_bilinear<dim> (targetLeaf->qData.leaf->coord.xyz, physical_length, xyz, coeff);
         // // Rho
         // for (int i = 0; i < tmp_lut->m_num_children; i++){
-        //     values_at_vertices[i] = targetLeaf->qData.leaf->user_data->prop_point[i].Rho;
+        //     values_at_vertices[i] = targetLeaf.user_data->prop_point[i].Rho;
         // }
         // bilinear_cal<dim>(coeff, values_at_vertices, prop.Rho);
         // // H
         // for (int i = 0; i < tmp_lut->m_num_children; i++){
-        //     values_at_vertices[i] = targetLeaf->qData.leaf->user_data->prop_point[i].H;
+        //     values_at_vertices[i] = targetLeaf.user_data->prop_point[i].H;
         // }
         // bilinear_cal<dim>(coeff, values_at_vertices, prop.H);
 
         // phase region
-        prop.Region = targetLeaf->qData.leaf->user_data->phaseRegion_cell;
+        prop.Region = targetLeaf.user_data->phaseRegion_cell;
 
         // delete[] values_at_vertices;
     }
 
     template<int dim>
-    void cH2ONaCl::interp_quad_prop(LOOKUPTABLE_FOREST::Quadrant<dim,H2ONaCl::FIELD_DATA<dim> > *targetLeaf, double* xyz_min_target, double* props, const double xyz[dim])
+    void cH2ONaCl::interp_quad_prop(LOOKUPTABLE_FOREST::LeafRef<dim,H2ONaCl::FIELD_DATA<dim> >& targetLeaf, double* xyz_min_target, double* props, const double xyz[dim])
     {
         LOOKUPTABLE_FOREST::LookUpTableForest<dim, H2ONaCl::FIELD_DATA<dim> >* tmp_lut = (LOOKUPTABLE_FOREST::LookUpTableForest<dim, H2ONaCl::FIELD_DATA<dim> >*)m_pLUT;
         double physical_length[dim]; //physical length of the quad
         double coeff[dim][2];
-        const int num_children = tmp_lut->m_num_children;
-        double* values_at_vertices = new double[tmp_lut->m_num_node_per_quad];
-        double** pNodeData = new double*[tmp_lut->m_num_node_per_quad];
+        const double* pNodeData[1<<dim]; //m_num_node_per_quad is always 2^dim
         // LOOKUPTABLE_FOREST::Quad_index *ijk_nodes_quad = new LOOKUPTABLE_FOREST::Quad_index[tmp_lut->m_num_node_per_quad]; // \todo 如果使用二阶插值，则需要更多节点，需要通过cellType进行判断：比如二维情况九点quad，那么需要限制max_level必须小于MAX_FOREST_LEVEL-2，不过这个好办，在构造函数里面判断一下进行安全检查就行
         // tmp_lut->get_ijk_nodes_quadrant(targetLeaf, &targetLeaf->qData.leaf->coord.ijk, tmp_lut->m_num_node_per_quad, ijk_nodes_quad);
 
-        tmp_lut->get_quadrant_physical_length((int)targetLeaf->level, physical_length);
+        tmp_lut->get_quadrant_physical_length(targetLeaf.level, physical_length);
         get_coeff_bilinear<dim> (xyz_min_target, physical_length, xyz, coeff);
         // for (int i = 0; i < dim; i++)
         // {
         //     cout<<"    "<<coeff[i][0]<<" "<<coeff[i][1]<<endl;
         // }
         
-        // interpolate props
-        int ind_prop =0;
+        // interpolate all props with the same coefficients
+        LOOKUPTABLE_FOREST::PropsData& data = tmp_lut->m_props_unique_points_leaves;
         for (int i = 0; i < tmp_lut->m_num_node_per_quad; i++){
-            pNodeData[i] = tmp_lut->m_props_unique_points_leaves.data[targetLeaf->qData.leaf->index_props[i]];
+            pNodeData[i] = &data.at(targetLeaf.index_props[i], 0);
+        }
+        bilinear_cal_props<dim>(coeff, pNodeData, data.stride_prop, data.num_props, props);
+    }
+
+    template<int dim>
+    void cH2ONaCl::lookup_batch(LOOKUPTABLE_FOREST::LookUpTableForest<dim,H2ONaCl::FIELD_DATA<dim> >* lut, int num_points, const double* x, const double* y, const double* z, double** props, H2ONaCl::PhaseRegion* phaseRegion, LOOKUPTABLE_FOREST::NeedRefine* need_refine)
+    {
+        const double* xyz_points[3] = {x, y, z};
+        // safety check: bound check, do it before the parallel loop because ERROR exits
+        for (int d = 0; d < dim; d++)
+        {
+            for (int i = 0; i < num_points; i++)
+            {
+                if(xyz_points[d][i]<lut->m_xyz_min[d] || xyz_points[d][i]>lut->m_xyz_max[d])
+                {
+                    ERROR("The lookup point "+to_string(i)+": ("+to_string(x[i])+", "+to_string(y[i])+(dim==3 ? ", "+to_string(z[i]) : "")+") out of lookup table range.");
+                }
+            }
+        }
+        LOOKUPTABLE_FOREST::PropsData& data = lut->m_props_unique_points_leaves;
+        const double constZ = lut->m_constZ;
+        // the points of a chunk are searched one by one, successive points in the same leaf are interpolated together
+        const int size_chunk = 256;
+        const int num_chunks = (num_points + size_chunk - 1)/size_chunk;
+    #ifdef USE_OMP
+        #pragma omp parallel for shared(lut, xyz_points, props, phaseRegion, need_refine, data)
+    #endif
+        for (int i_chunk = 0; i_chunk < num_chunks; i_chunk++)
+        {
+            LOOKUPTABLE_FOREST::LeafRef<dim,H2ONaCl::FIELD_DATA<dim> > targetLeaf, runLeaf;
+            double xyz[dim], xyz_min_target[dim], xyz_min_run[dim], physical_length[dim];
+            const double* pNodeData[1<<dim];
+            const int i_end = min((i_chunk + 1)*size_chunk, num_points);
+            int i_begin = i_chunk*size_chunk;
+            for (int i = i_begin; i <= i_end; i++)
+            {
+                if(i < i_end)
+                {
+                    for (int d = 0; d < dim; d++)xyz[d] = xyz_points[d][i];
+                    lut->searchLeaf(targetLeaf, xyz_min_target, xyz[0], xyz[1], dim==3 ? xyz[dim-1] : constZ);
+                    if(i > i_begin && targetLeaf.user_data == runLeaf.user_data)continue;
+                }
+                // interpolate the run of points [i_begin, i) in runLeaf
+                if(i > i_begin)
+                {
+                    lut->get_quadrant_physical_length(runLeaf.level, physical_length);
+                    for (int i_node = 0; i_node < (1<<dim); i_node++)pNodeData[i_node] = &data.at(runLeaf.index_props[i_node], 0);
+                    bilinear_cal_props_batch<dim>(xyz_min_run, physical_length, pNodeData, data.stride_prop, data.num_props, xyz_points, i_begin, i - i_begin, props);
+                    for (int k = i_begin; k < i; k++)
+                    {
+                        if(phaseRegion)phaseRegion[k] = runLeaf.user_data->phaseRegion_cell;
+                        if(need_refine)need_refine[k] = runLeaf.user_data->need_refine;
+                    }
+                }
+                runLeaf = targetLeaf;
+                for (int d = 0; d < dim; d++)xyz_min_run[d] = xyz_min_target[d];
+                i_begin = i;
+            }
         }
-        for(auto &map_props : tmp_lut->m_map_props)
+    }
+
+    void cH2ONaCl::lookup_batch(int num_points, const double* x, const double* y, const double* z, double** props, H2ONaCl::PhaseRegion* phaseRegion, LOOKUPTABLE_FOREST::NeedRefine* need_refine)
+    {
+        if(!m_pLUT)ERROR("The LUT is not created or loaded, please call createLUT_2D/createLUT_3D or loadLUT first.");
+        switch (m_dim_lut)
         {
-            // if(ind_prop==0)cout<<" prop: "<<map_props.second.longName<<endl;
-            for (int i = 0; i < tmp_lut->m_num_node_per_quad; i++){
-                values_at_vertices[i] = pNodeData[i][ind_prop]; //\todo need to be optimized, this map index takes more time
-                // if(ind_prop==0)cout<<"    node "<<i<<" : "<<values_at_vertices[i]<<endl;
+        case 2:
+            lookup_batch<2>((LookUpTableForest_2D*)m_pLUT, num_points, x, y, z, props, phaseRegion, need_refine);
+            break;
+        case 3:
+            if(!z)ERROR("The z coordinate of the points is required by a 3D LUT in lookup_batch.");
+            lookup_batch<3>((LookUpTableForest_3D*)m_pLUT, num_points, x, y, z, props, phaseRegion, need_refine);
+            break;
+        default:
+            ERROR("The dim of the LUT must be 2 or 3 in lookup_batch.");
+            break;
+        }
+    }
+
+    void cH2ONaCl::cal_prop_lut_point(double* props, double x, double y, double z)
+    {
+        LOOKUPTABLE_FOREST::EOS_ENERGY TorH;
+        std::map<int, propInfo>* map_props;
+        double p, TorH_value, X;
+        if(m_dim_lut == 2)
+        {
+            LookUpTableForest_2D* tmp_lut = (LookUpTableForest_2D*)m_pLUT;
+            TorH = tmp_lut->m_TorH;
+            map_props = &tmp_lut->m_map_props;
+            switch (tmp_lut->m_const_which_var)
+            {
+            case LOOKUPTABLE_FOREST::CONST_X_VAR_TorHP:
+                p = y; TorH_value = x; X = tmp_lut->m_constZ;
+                break;
+            case LOOKUPTABLE_FOREST::CONST_P_VAR_XTorH:
+                p = tmp_lut->m_constZ; TorH_value = y; X = x;
+                break;
+            case LOOKUPTABLE_FOREST::CONST_TorH_VAR_XP:
+                p = y; TorH_value = tmp_lut->m_constZ; X = x;
+                break;
+            default:
+                ERROR("Impossible case occurs in cH2ONaCl::cal_prop_lut_point");
+                break;
             }
-            bilinear_cal<dim>(coeff, values_at_vertices, props[ind_prop]);
-            ind_prop++;
+        }else
+        {
+            LookUpTableForest_3D* tmp_lut = (LookUpTableForest_3D*)m_pLUT;
+            TorH = tmp_lut->m_TorH;
+            map_props = &tmp_lut->m_map_props;
+            p = y; TorH_value = x; X = z; //For 3D case, the order of x,y,z MUST BE TorH, p, X.
+        }
+        PROP_H2ONaCl tmp_prop;
+        if(TorH == LOOKUPTABLE_FOREST::EOS_ENERGY_T)
+        {
+            tmp_prop = prop_pTX(p, TorH_value, X);
+        }else if(TorH == LOOKUPTABLE_FOREST::EOS_ENERGY_H)
+        {
+            tmp_prop = prop_pHX(p, TorH_value, X);
+        }else
+        {
+            ERROR("The EOS space only support TPX and HPX!");
+        }
+        fill_prop2data(this, &tmp_prop, *map_props, props);
+    }
+
+    int cH2ONaCl::lookup_batch_deferred(int num_points, const double* x, const double* y, const double* z, double** props, std::vector<int>& index_deferred, H2ONaCl::PhaseRegion* phaseRegion, LOOKUPTABLE_FOREST::NeedRefine* need_refine)
+    {
+        std::vector<LOOKUPTABLE_FOREST::NeedRefine> need_refine_tmp;
+        if(!need_refine)
+        {
+            need_refine_tmp.resize(num_points);
+            need_refine = need_refine_tmp.data();
+        }
+        lookup_batch(num_points, x, y, z, props, phaseRegion, need_refine);
+        index_deferred.clear();
+        for (int i = 0; i < num_points; i++)
+        {
+            if(need_refine[i])index_deferred.push_back(i);
+        }
+        return (int)index_deferred.size();
+    }
+
+    void cH2ONaCl::cal_deferred(const std::vector<int>& index_deferred, const double* x, const double* y, const double* z, double** props)
+    {
+        if(!m_pLUT)ERROR("The LUT is not created or loaded, please call createLUT_2D/createLUT_3D or loadLUT first.");
+        if(m_dim_lut == 3 && !z)ERROR("The z coordinate of the points is required by a 3D LUT in cal_deferred.");
+        const int num_props = m_dim_lut == 2 ? ((LookUpTableForest_2D*)m_pLUT)->m_map_props.size() : ((LookUpTableForest_3D*)m_pLUT)->m_map_props.size();
+        const int num_deferred = (int)index_deferred.size();
+        // the cost of a point depends on the phase region, so the points are dealt out in small pieces
+    #ifdef USE_OMP
+        #pragma omp parallel for schedule(dynamic, 4) shared(index_deferred, x, y, z, props)
+    #endif
+        for (int k = 0; k < num_deferred; k++)
+        {
+            const int i = index_deferred[k];
+            std::vector<double> props_point(num_props);
+            cal_prop_lut_point(props_point.data(), x[i], y[i], m_dim_lut == 3 ? z[i] : 0);
+            for (int j = 0; j < num_props; j++)props[j][i] = props_point[j];
         }
-        delete[] values_at_vertices;
-        delete[] pNodeData;
     }
 
-    LOOKUPTABLE_FOREST::Quadrant<2,H2ONaCl::FIELD_DATA<2> > * cH2ONaCl::lookup(double* props, double* xyz_min_target,  double x, double y, bool is_cal)
+    int cH2ONaCl::lookup_batch_cal(int num_points, const double* x, const double* y, const double* z, double** props, H2ONaCl::PhaseRegion* phaseRegion)
+    {
+        std::vector<int> index_deferred;
+        int num_deferred = lookup_batch_deferred(num_points, x, y, z, props, index_deferred, phaseRegion);
+        cal_deferred(index_deferred, x, y, z, props);
+        return num_deferred;
+    }
+
+    LOOKUPTABLE_FOREST::Quadrant<2,H2ONaCl::FIELD_DATA<2> > * cH2ONaCl::lookup(double* props, double* xyz_min_target,  double x, double y, bool is_cal, LOOKUPTABLE_FOREST::NeedRefine* need_refine)
     {
         LookUpTableForest_2D* tmp_lut = (LookUpTableForest_2D*)m_pLUT; // make temporary copy of the pointer
         // safety check: bound check
@@ -4645,13 +5110,13 @@ namespace H2ONaCl
         }
         // -------------------------------
         // cout<<"constZ: "<<tmp_lut->m_constZ<<", y: "<<y<<", x: "<<x<<endl;
-        LOOKUPTABLE_FOREST::Quadrant<2,H2ONaCl::FIELD_DATA<2> > *targetLeaf = NULL;
+        LOOKUPTABLE_FOREST::LeafRef<2,H2ONaCl::FIELD_DATA<2> > targetLeaf;
         // double xyz_min_target[2];
-        tmp_lut->searchQuadrant(targetLeaf, xyz_min_target, x, y, tmp_lut->m_constZ);
+        tmp_lut->searchLeaf(targetLeaf, xyz_min_target, x, y, tmp_lut->m_constZ);
         // cout<<xyz_min_target[0]-targetLeaf->qData.leaf->coord.xyz[0]<<"   "<<xyz_min_target[1] - targetLeaf->qData.leaf->coord.xyz[1]<<endl;
         // cout<<"  level: "<<targetLeaf->level<<", x: "<<x<<", y: "<<y<<", quad x: "<<targetLeaf->qData.leaf->coord.xyz[0]<<", quad y: "<<targetLeaf->qData.leaf->coord.xyz[1]<<endl;
         PROP_H2ONaCl tmp_prop;
-        if(targetLeaf->qData.leaf->user_data->need_refine)
+        if(targetLeaf.user_data->need_refine)
         {
             if(is_cal) // if set is_cal true means cal properties using acurate equation, otherwise interpolate anyway
             {
@@ -4712,17 +5177,18 @@ namespace H2ONaCl
             interp_quad_prop<2>(targetLeaf,xyz_min_target, props, xy);
             // cout<<"lookup: "<<x<<", "<<y<<", rho: "<<props[0]<<endl;
         }
-        return targetLeaf;
+        if(need_refine)*need_refine = targetLeaf.user_data->need_refine;
+        return targetLeaf.quad; //NULL if the LUT uses linear storage, use need_refine instead
     }
 
-    LOOKUPTABLE_FOREST::Quadrant<2,H2ONaCl::FIELD_DATA<2> > * cH2ONaCl::lookup(H2ONaCl::PROP_H2ONaCl& prop, double x, double y)
+    LOOKUPTABLE_FOREST::Quadrant<2,H2ONaCl::FIELD_DATA<2> > * cH2ONaCl::lookup(H2ONaCl::PROP_H2ONaCl& prop, double x, double y, LOOKUPTABLE_FOREST::NeedRefine* need_refine)
     {
         LookUpTableForest_2D* tmp_lut = (LookUpTableForest_2D*)m_pLUT; // make temporary copy of the pointer
         // cout<<"constZ: "<<tmp_lut->m_constZ<<", y: "<<y<<", x: "<<x<<endl;
-        LOOKUPTABLE_FOREST::Quadrant<2,H2ONaCl::FIELD_DATA<2> > *targetLeaf = NULL;
+        LOOKUPTABLE_FOREST::LeafRef<2,H2ONaCl::FIELD_DATA<2> > targetLeaf;
         double xyz_min_target[2];
-        tmp_lut->searchQuadrant(targetLeaf, xyz_min_target, x, y, tmp_lut->m_constZ);
-        if(targetLeaf->qData.leaf->user_data->need_refine)
+        tmp_lut->searchLeaf(targetLeaf, xyz_min_target, x, y, tmp_lut->m_constZ);
+        if(targetLeaf.user_data->need_refine)
         {
             if(tmp_lut->m_TorH == LOOKUPTABLE_FOREST::EOS_ENERGY_T)
             {
@@ -4768,7 +5234,8 @@ namespace H2ONaCl
             double xy[2] = {x, y};
             interp_quad_prop<2>(targetLeaf,xyz_min_target, prop, xy);
         }
-        return targetLeaf;
+        if(need_refine)*need_refine = targetLeaf.user_data->need_refine;
+        return targetLeaf.quad; //NULL if the LUT uses linear storage, use need_refine instead
     }
 
     // for python API
@@ -4786,7 +5253,7 @@ namespace H2ONaCl
         return prop;
     }
 
-    LOOKUPTABLE_FOREST::Quadrant<3,H2ONaCl::FIELD_DATA<3> > * cH2ONaCl::lookup(H2ONaCl::PROP_H2ONaCl& prop, double x, double y, double z)
+    LOOKUPTABLE_FOREST::Quadrant<3,H2ONaCl::FIELD_DATA<3> > * cH2ONaCl::lookup(H2ONaCl::PROP_H2ONaCl& prop, double x, double y, double z, LOOKUPTABLE_FOREST::NeedRefine* need_refine)
     {
         if(m_dim_lut!=3)ERROR("The dim of the LUT is not 3, but you call the 3D lookup function");
 
@@ -4798,10 +5265,10 @@ namespace H2ONaCl
         }
         // -------------------------------
         // cout<<"T: "<<x<<", P: "<<y<<", X: "<<z<<endl;
-        LOOKUPTABLE_FOREST::Quadrant<3,H2ONaCl::FIELD_DATA<3> > *targetLeaf = NULL;
+        LOOKUPTABLE_FOREST::LeafRef<3,H2ONaCl::FIELD_DATA<3> > targetLeaf;
         double xyz_min_target[3];
-        tmp_lut->searchQuadrant(targetLeaf, xyz_min_target, x, y, z);
-        if(targetLeaf->qData.leaf->user_data->need_refine)
+        tmp_lut->searchLeaf(targetLeaf, xyz_min_target, x, y, z);
+        if(targetLeaf.user_data->need_refine)
         {
             if(tmp_lut->m_TorH == LOOKUPTABLE_FOREST::EOS_ENERGY_T)
             {
@@ -4819,10 +5286,11 @@ namespace H2ONaCl
             double xyz[3] = {x, y, z};
             interp_quad_prop<3>(targetLeaf,xyz_min_target, prop, xyz);
         }
-        return targetLeaf;
+        if(need_refine)*need_refine = targetLeaf.user_data->need_refine;
+        return targetLeaf.quad; //NULL if the LUT uses linear storage, use need_refine instead
     }
 
-    LOOKUPTABLE_FOREST::Quadrant<3,H2ONaCl::FIELD_DATA<3> > * cH2ONaCl::lookup(double* props, double* xyz_min_target,  double x, double y, double z, bool is_cal)
+    LOOKUPTABLE_FOREST::Quadrant<3,H2ONaCl::FIELD_DATA<3> > * cH2ONaCl::lookup(double* props, double* xyz_min_target,  double x, double y, double z, bool is_cal, LOOKUPTABLE_FOREST::NeedRefine* need_refine)
     {
         if(m_dim_lut!=3)ERROR("The dim of the LUT is not 3, but you call the 3D lookup function");
 
@@ -4834,11 +5302,11 @@ namespace H2ONaCl
         }
         // -------------------------------
         // cout<<"T: "<<x<<", P: "<<y<<", X: "<<z<<endl;
-        LOOKUPTABLE_FOREST::Quadrant<3,H2ONaCl::FIELD_DATA<3> > *targetLeaf = NULL;
+        LOOKUPTABLE_FOREST::LeafRef<3,H2ONaCl::FIELD_DATA<3> > targetLeaf;
         // double xyz_min_target[3];
-        tmp_lut->searchQuadrant(targetLeaf, xyz_min_target, x, y, z);
+        tmp_lut->searchLeaf(targetLeaf, xyz_min_target, x, y, z);
         PROP_H2ONaCl tmp_prop;
-        if(targetLeaf->qData.leaf->user_data->need_refine)
+        if(targetLeaf.user_data->need_refine)
         {
             if(is_cal)
             {
@@ -4865,28 +5333,30 @@ namespace H2ONaCl
             double xyz[3] = {x, y, z};
             interp_quad_prop<3>(targetLeaf,xyz_min_target, props, xyz);
         }
-        return targetLeaf;
+        if(need_refine)*need_refine = targetLeaf.user_data->need_refine;
+        return targetLeaf.quad; //NULL if the LUT uses linear storage, use need_refine instead
     }
 
-    LOOKUPTABLE_FOREST::Quadrant<2,H2ONaCl::FIELD_DATA<2> > * cH2ONaCl::lookup_only(H2ONaCl::PROP_H2ONaCl& prop, double x, double y)
+    LOOKUPTABLE_FOREST::Quadrant<2,H2ONaCl::FIELD_DATA<2> > * cH2ONaCl::lookup_only(H2ONaCl::PROP_H2ONaCl& prop, double x, double y, LOOKUPTABLE_FOREST::NeedRefine* need_refine)
     {
         LookUpTableForest_2D* tmp_lut = (LookUpTableForest_2D*)m_pLUT; // make temporary copy of the pointer
         // cout<<"constZ: "<<tmp_lut->m_constZ<<", y: "<<y<<", x: "<<x<<endl;
-        LOOKUPTABLE_FOREST::Quadrant<2,H2ONaCl::FIELD_DATA<2> > *targetLeaf = NULL;
+        LOOKUPTABLE_FOREST::LeafRef<2,H2ONaCl::FIELD_DATA<2> > targetLeaf;
         double xyz_min_target[2];
-        tmp_lut->searchQuadrant(targetLeaf, xyz_min_target, x, y, tmp_lut->m_constZ);
-        if(targetLeaf->qData.leaf->user_data->need_refine)
+        tmp_lut->searchLeaf(targetLeaf, xyz_min_target, x, y, tmp_lut->m_constZ);
+        if(targetLeaf.user_data->need_refine)
         {
             //only lookup, so don't do anything if the lookup point in the needRefine-cell
-            prop.Region = targetLeaf->qData.leaf->user_data->phaseRegion_cell;
+            prop.Region = targetLeaf.user_data->phaseRegion_cell;
         }
         else
         {
             double xy[2] = {x, y};
             interp_quad_prop<2>(targetLeaf,xyz_min_target, prop, xy);
-            prop.Region = targetLeaf->qData.leaf->user_data->phaseRegion_cell;
+            prop.Region = targetLeaf.user_data->phaseRegion_cell;
         }
-        return targetLeaf;
+        if(need_refine)*need_refine = targetLeaf.user_data->need_refine;
+        return targetLeaf.quad; //NULL if the LUT uses linear storage, use need_refine instead
     }
 
     // for python API
@@ -4904,27 +5374,28 @@ namespace H2ONaCl
         return prop;
     }
 
-    LOOKUPTABLE_FOREST::Quadrant<3,H2ONaCl::FIELD_DATA<3> > * cH2ONaCl::lookup_only(H2ONaCl::PROP_H2ONaCl& prop, double x, double y, double z)
+    LOOKUPTABLE_FOREST::Quadrant<3,H2ONaCl::FIELD_DATA<3> > * cH2ONaCl::lookup_only(H2ONaCl::PROP_H2ONaCl& prop, double x, double y, double z, LOOKUPTABLE_FOREST::NeedRefine* need_refine)
     {
         if(m_dim_lut!=3)ERROR("The dim of the LUT is not 3, but you call the 3D lookup function");
 
         LookUpTableForest_3D* tmp_lut = (LookUpTableForest_3D*)m_pLUT; // make temporary copy of the pointer
         // cout<<"T: "<<x<<", P: "<<y<<", X: "<<z<<endl;
-        LOOKUPTABLE_FOREST::Quadrant<3,H2ONaCl::FIELD_DATA<3> > *targetLeaf = NULL;
+        LOOKUPTABLE_FOREST::LeafRef<3,H2ONaCl::FIELD_DATA<3> > targetLeaf;
         double xyz_min_target[3];
-        tmp_lut->searchQuadrant(targetLeaf, xyz_min_target, x, y, z);
-        if(targetLeaf->qData.leaf->user_data->need_refine)
+        tmp_lut->searchLeaf(targetLeaf, xyz_min_target, x, y, z);
+        if(targetLeaf.user_data->need_refine)
         {
             //this is a looup-only version, don't do anything if the lookup point in the needRefine-cell
-            prop.Region = targetLeaf->qData.leaf->user_data->phaseRegion_cell;
+            prop.Region = targetLeaf.user_data->phaseRegion_cell;
         }
         else
         {
             double xyz[3] = {x, y, z};
             interp_quad_prop<3>(targetLeaf,xyz_min_target, prop, xyz);
-            prop.Region = targetLeaf->qData.leaf->user_data->phaseRegion_cell;
+            prop.Region = targetLeaf.user_data->phaseRegion_cell;
         }
-        return targetLeaf;
+        if(need_refine)*need_refine = targetLeaf.user_data->need_refine;
+        return targetLeaf.quad; //NULL if the LUT uses linear storage, use need_refine instead
     }
 
 
@@ -4936,10 +5407,12 @@ namespace H2ONaCl
         switch (m_dim_lut)
         {
         case 2:
-            m_pLUT = (LookUpTableForest_2D*)(new LookUpTableForest_2D(filename, this));
+            m_pLUT = (LookUpTableForest_2D*)(new LookUpTableForest_2D(filename, this, m_lut_storage));
+            ((LookUpTableForest_2D*)m_pLUT)->set_props_layout(m_lut_props_layout);
             break;
         case 3:
-            m_pLUT = (LookUpTableForest_3D*)(new LookUpTableForest_3D(filename, this));
+            m_pLUT = (LookUpTableForest_3D*)(new LookUpTableForest_3D(filename, this, m_lut_storage));
+            ((LookUpTableForest_3D*)m_pLUT)->set_props_layout(m_lut_props_layout);
             break;
         default:
             ERROR("The dim in the binary file is neither 2 nor 3, it is not a valid LUT file: "+filename);
@@ -0,0 +1,317 @@
+#include "vtuWriter.h"
+#include <cstring>
+
+namespace VTU
+{
+    // ============================== deflate (RFC 1951) with fixed Huffman codes ==============================
+    static const int DEFLATE_WINDOW = 32768;
+    static const int DEFLATE_MIN_MATCH = 3;
+    static const int DEFLATE_MAX_MATCH = 258;
+    static const int DEFLATE_MAX_CHAIN = 32; //longest hash chain searched for a match, it trades compression for speed
+    static const int DEFLATE_HASH_BITS = 15;
+    static const int length_base[29] = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258};
+    static const int length_extra[29] = {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0};
+    static const int dist_base[30] = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577};
+    static const int dist_extra[30] = {0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
+
+    class BitWriter
+    {
+    private:
+        std::vector<unsigned char>& m_out;
+        unsigned long long m_bits;
+        int m_num_bits;
+    public:
+        BitWriter(std::vector<unsigned char>& out) : m_out(out), m_bits(0), m_num_bits(0){};
+        // value is written from its least significant bit, as the extra bits and the block header
+        inline void put(unsigned int value, int num_bits)
+        {
+            m_bits |= (unsigned long long)value << m_num_bits;
+            m_num_bits += num_bits;
+            while (m_num_bits >= 8)
+            {
+                m_out.push_back((unsigned char)(m_bits & 0xFF));
+                m_bits >>= 8;
+                m_num_bits -= 8;
+            }
+        }
+        // Huffman codes are written from their most significant bit
+        inline void put_code(unsigned int code, int num_bits)
+        {
+            unsigned int reversed = 0;
+            for (int i = 0; i < num_bits; i++)reversed = (reversed << 1) | ((code >> i) & 1);
+            put(reversed, num_bits);
+        }
+        void flush()
+        {
+            if(m_num_bits > 0)m_out.push_back((unsigned char)(m_bits & 0xFF));
+            m_bits = 0;
+            m_num_bits = 0;
+        }
+    };
+
+    static inline void put_symbol(BitWriter& bw, int symbol)
+    {
+        if(symbol < 144)bw.put_code(0x30 + symbol, 8);
+        else if(symbol < 256)bw.put_code(0x190 + symbol - 144, 9);
+        else if(symbol < 280)bw.put_code(symbol - 256, 7);
+        else bw.put_code(0xC0 + symbol - 280, 8);
+    }
+
+    static inline void put_match(BitWriter& bw, int length, int distance)
+    {
+        int i_length = 28;
+        if(length < DEFLATE_MAX_MATCH)
+        {
+            i_length = 27;
+            while (length_base[i_length] > length)i_length--;
+        }
+        put_symbol(bw, 257 + i_length);
+        if(length_extra[i_length] > 0)bw.put(length - length_base[i_length], length_extra[i_length]);
+        int i_dist = 29;
+        while (dist_base[i_dist] > distance)i_dist--;
+        bw.put_code(i_dist, 5);
+        if(dist_extra[i_dist] > 0)bw.put(distance - dist_base[i_dist], dist_extra[i_dist]);
+    }
+
+    static inline unsigned int hash3(const unsigned char* p)
+    {
+        return ((p[0] << 16 | p[1] << 8 | p[2]) * 2654435761u) >> (32 - DEFLATE_HASH_BITS);
+    }
+
+    // one final block with the fixed Huffman codes, greedy LZ77 matching on hash chains
+    static void deflate_fixed(const unsigned char* data, size_t size, std::vector<unsigned char>& out)
+    {
+        BitWriter bw(out);
+        bw.put(1, 1); //BFINAL
+        bw.put(1, 2); //BTYPE = 01, fixed Huffman codes
+        std::vector<int> head(1<<DEFLATE_HASH_BITS, -1);
+        std::vector<int> prev(size);
+        size_t i = 0;
+        while (i < size)
+        {
+            int best_length = 0, best_distance = 0;
+            if(i + DEFLATE_MIN_MATCH <= size)
+            {
+                unsigned int h = hash3(data + i);
+                int max_length = (int)(size - i < (size_t)DEFLATE_MAX_MATCH ? size - i : DEFLATE_MAX_MATCH);
+                int candidate = head[h];
+                for (int chain = 0; candidate >= 0 && (int)i - candidate <= DEFLATE_WINDOW && chain < DEFLATE_MAX_CHAIN; chain++)
+                {
+                    const unsigned char* p = data + candidate;
+                    const unsigned char* q = data + i;
+                    int length = 0;
+                    while (length < max_length && p[length] == q[length])length++;
+                    if(length > best_length)
+                    {
+                        best_length = length;
+                        best_distance = (int)i - candidate;
+                        if(length == max_length)break;
+                    }
+                    candidate = prev[candidate];
+                }
+                prev[i] = head[h];
+                head[h] = (int)i;
+            }
+            if(best_length >= DEFLATE_MIN_MATCH)
+            {
+                put_match(bw, best_length, best_distance);
+                for (size_t k = i + 1; k < i + best_length && k + DEFLATE_MIN_MATCH <= size; k++)
+                {
+                    unsigned int h = hash3(data + k);
+                    prev[k] = head[h];
+                    head[h] = (int)k;
+                }
+                i += best_length;
+            }else
+            {
+                put_symbol(bw, data[i]);
+                i++;
+            }
+        }
+        put_symbol(bw, 256); //end of block
+        bw.flush();
+    }
+
+    static void deflate_stored(const unsigned char* data, size_t size, std::vector<unsigned char>& out)
+    {
+        size_t i = 0;
+        do
+        {
+            size_t length = size - i < 65535 ? size - i : 65535;
+            out.push_back(i + length == size ? 1 : 0); //BFINAL, BTYPE = 00
+            out.push_back(length & 0xFF);
+            out.push_back((length >> 8) & 0xFF);
+            out.push_back(~length & 0xFF);
+            out.push_back((~length >> 8) & 0xFF);
+            out.insert(out.end(), data + i, data + i + length);
+            i += length;
+        } while (i < size);
+    }
+
+    static unsigned int adler32(const unsigned char* data, size_t size)
+    {
+        unsigned int a = 1, b = 0;
+        while (size > 0)
+        {
+            size_t n = size < 5552 ? size : 5552; //the largest n such that the sums don't overflow before the modulo
+            for (size_t i = 0; i < n; i++)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += n;
+            size -= n;
+        }
+        return b << 16 | a;
+    }
+
+    size_t zlib_compress(const void* data, size_t size, std::vector<unsigned char>& out)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        size_t size_begin = out.size();
+        out.push_back(0x78); //CMF: deflate, 32K window
+        out.push_back(0x01); //FLG: fastest compression, no dictionary
+        size_t size_header = out.size();
+        deflate_fixed(bytes, size, out);
+        size_t size_stored = size + 5*(size/65535 + 1);
+        if(out.size() - size_header > size_stored)
+        {
+            out.resize(size_header);
+            deflate_stored(bytes, size, out);
+        }
+        unsigned int checksum = adler32(bytes, size);
+        for (int i = 3; i >= 0; i--)out.push_back((checksum >> (8*i)) & 0xFF);
+        return out.size() - size_begin;
+    }
+
+    // ============================== base64 ==============================
+    static const char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    void Base64Stream::write(const void* data, size_t size)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        char buffer[4096];
+        size_t num_buffer = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            m_carry[m_num_carry++] = bytes[i];
+            if(m_num_carry == 3)
+            {
+                buffer[num_buffer++] = BASE64_CHARS[m_carry[0] >> 2];
+                buffer[num_buffer++] = BASE64_CHARS[(m_carry[0] & 0x03) << 4 | m_carry[1] >> 4];
+                buffer[num_buffer++] = BASE64_CHARS[(m_carry[1] & 0x0F) << 2 | m_carry[2] >> 6];
+                buffer[num_buffer++] = BASE64_CHARS[m_carry[2] & 0x3F];
+                m_num_carry = 0;
+                if(num_buffer == sizeof(buffer))
+                {
+                    fwrite(buffer, 1, num_buffer, m_fp);
+                    m_num_chars += num_buffer;
+                    num_buffer = 0;
+                }
+            }
+        }
+        fwrite(buffer, 1, num_buffer, m_fp);
+        m_num_chars += num_buffer;
+    }
+
+    void Base64Stream::finish()
+    {
+        if(m_num_carry == 0)return;
+        char quad[4] = {'=', '=', '=', '='};
+        if(m_num_carry == 1)m_carry[1] = 0;
+        quad[0] = BASE64_CHARS[m_carry[0] >> 2];
+        quad[1] = BASE64_CHARS[(m_carry[0] & 0x03) << 4 | m_carry[1] >> 4];
+        if(m_num_carry == 2)quad[2] = BASE64_CHARS[(m_carry[1] & 0x0F) << 2];
+        fwrite(quad, 1, 4, m_fp);
+        m_num_chars += 4;
+        m_num_carry = 0;
+    }
+
+    // ============================== appended data ==============================
+    AppendedData::AppendedData(ENCODING encoding, bool compress, size_t size_block)
+    :
+    m_encoding(encoding),
+    m_compress(compress),
+    m_size_block(size_block),
+    m_offset(0)
+    {
+    }
+
+    size_t AppendedData::add(const void* data, size_t size)
+    {
+        size_t offset = m_offset;
+        m_arrays.push_back(Array());
+        Array& array = m_arrays.back();
+        array.data = data;
+        array.size = size;
+        if(m_compress)
+        {
+            size_t num_blocks = (size + m_size_block - 1)/m_size_block;
+            std::vector<unsigned long long> header(3 + num_blocks);
+            header[0] = num_blocks;
+            header[1] = m_size_block;
+            header[2] = size % m_size_block; //size of the partial last block, 0 if the last block is full
+            for (size_t i = 0; i < num_blocks; i++)
+            {
+                size_t begin = i*m_size_block;
+                header[3 + i] = zlib_compress((const unsigned char*)data + begin, size - begin < m_size_block ? size - begin : m_size_block, array.blocks);
+            }
+            array.header.resize(header.size()*sizeof(unsigned long long));
+            memcpy(array.header.data(), header.data(), array.header.size());
+            if(m_encoding == ENCODING_RAW)m_offset += array.header.size() + array.blocks.size();
+            else m_offset += Base64Stream::encoded_size(array.header.size()) + Base64Stream::encoded_size(array.blocks.size());
+        }else
+        {
+            if(m_encoding == ENCODING_RAW)m_offset += sizeof(unsigned long long) + size;
+            else m_offset += Base64Stream::encoded_size(sizeof(unsigned long long) + size);
+        }
+        return offset;
+    }
+
+    std::string AppendedData::file_attributes()
+    {
+        return m_compress ? " compressor=\"vtkZLibDataCompressor\"" : "";
+    }
+
+    void AppendedData::write(FILE* fp)
+    {
+        fprintf(fp, "  <AppendedData encoding=\"%s\">\n   _", m_encoding == ENCODING_RAW ? "raw" : "base64");
+        for (size_t i = 0; i < m_arrays.size(); i++)
+        {
+            Array& array = m_arrays[i];
+            if(m_encoding == ENCODING_RAW)
+            {
+                if(m_compress)
+                {
+                    fwrite(array.header.data(), 1, array.header.size(), fp);
+                    fwrite(array.blocks.data(), 1, array.blocks.size(), fp);
+                }else
+                {
+                    fwrite(&array.size, sizeof(unsigned long long), 1, fp);
+                    fwrite(array.data, 1, array.size, fp);
+                }
+            }else
+            {
+                // the compression header and the blocks are encoded separately, the size header and uncompressed data are one stream
+                Base64Stream stream(fp);
+                if(m_compress)
+                {
+                    stream.write(array.header.data(), array.header.size());
+                    stream.finish();
+                    stream.write(array.blocks.data(), array.blocks.size());
+                    stream.finish();
+                }else
+                {
+                    stream.write(&array.size, sizeof(unsigned long long));
+                    stream.write(array.data, array.size);
+                    stream.finish();
+                }
+            }
+            // release the compressed blocks as soon as they are written
+            std::vector<unsigned char>().swap(array.blocks);
+        }
+        fprintf(fp, "\n  </AppendedData>\n");
+    }
+}
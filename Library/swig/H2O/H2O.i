@@ -41,6 +41,14 @@ namespace H2O
         double n0[8]={-8.32044648201, 6.6832105268, 3.00632, 0.012436, 0.97315, 1.2795, 0.96956, 0.24873};
         double gamma0[8]={0, 0, 0, 1.28728967, 3.53734222, 7.74073708, 9.24437796, 27.5075105};
     };
+    /**
+     * @brief Properties of water at one state (T, P), see H2O::cH2O::State.
+     * 
+     */
+    struct WaterState
+    {
+        double T, P, Rho, H, Cv, Cp, Mu, alpha, beta;
+    };
     // ============= Constants of H2O ========================================================================
     double const PMIN = 1E5; /**< Minimum valid pressure of H2O, [Pa]. IAPWS-95 */ 
     double const PMAX = 10000E5; /**< Minimum valid pressure of H2O, [Pa]. IAPWS-95 */ 
@@ -202,6 +210,14 @@ namespace H2O
          * @return Specific enthalpy [\f$ J/kg \f$] 
          */
         double SpecificEnthalpy(double T, double P);
+        /**
+         * @brief Density, specific enthalpy, heat capacities, viscosity, isobaric expansivity and isotermal compressibility from one density solve.
+         * 
+         * @param T Temperature [\f$ ^{\circ}\text{C} \f$]
+         * @param P Pressure [\f$ bar \f$]
+         * @return WaterState 
+         */
+        WaterState State(double T, double P);
     public:
         
     };
@@ -28,6 +28,43 @@ using namespace std;
     #include "LookUpTableForest.h"
     #include "omp.h"
     #define USE_PROST 1
+#ifdef SWIGPYTHON
+    #include <deque>
+    #include <climits>
+    /**
+     * @brief Arrays of a vectorized call (see prop_pTX_array) accessed through the buffer protocol, so NumPy arrays are not copied. 
+     * The arrays must be C-contiguous float64 or int32 arrays, the Python wrappers prepare them by numpy.ascontiguousarray. The buffers are released with the object.
+     */
+    class ArrayViews
+    {
+    public:
+        ~ArrayViews(){for (size_t i = 0; i < m_views.size(); i++)PyBuffer_Release(&m_views[i]);}
+        /**
+         * @brief Data of a float64 (format 'd') or int32 (format 'i') array of num_items items, return NULL with a Python exception if obj is not such an array.
+         */
+        void* get(PyObject* obj, char format, bool writable, Py_ssize_t num_items)
+        {
+            m_views.emplace_back();
+            Py_buffer& view = m_views.back();
+            if(PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0)) != 0)
+            {
+                m_views.pop_back();
+                return NULL;
+            }
+            const char* fmt = view.format;
+            if(fmt && (fmt[0] == '<' || fmt[0] == '=' || fmt[0] == '@'))fmt++;
+            bool isFormat = fmt && fmt[1] == '\0' && (format == 'd' ? (fmt[0] == 'd' && view.itemsize == sizeof(double)) : ((fmt[0] == 'i' || fmt[0] == 'l') && view.itemsize == sizeof(int)));
+            if(!isFormat || view.len/view.itemsize != num_items)
+            {
+                PyErr_Format(PyExc_ValueError, "Expect a contiguous %s array of %zd items", format == 'd' ? "float64" : "int32", num_items);
+                return NULL;
+            }
+            return view.buf;
+        }
+    private:
+        std::deque<Py_buffer> m_views; //a deque keeps the address of the views
+    };
+#endif
 %}
 
 namespace LOOKUPTABLE_FOREST
@@ -89,6 +126,15 @@ namespace LOOKUPTABLE_FOREST
         EOS_ENERGY_T, /**< TPX space */
         EOS_ENERGY_H  /**< HPX space */
         };
+    /**
+     * @brief Format of the data arrays of a .vtu file
+     * 
+     */
+    enum VTU_FORMAT {
+        VTU_FORMAT_ASCII,   /**< Inline text data arrays, compression is ignored */
+        VTU_FORMAT_RAW,     /**< Binary data arrays in the raw AppendedData section */
+        VTU_FORMAT_BASE64   /**< Base64 encoded data arrays in the AppendedData section, the file is valid XML */
+        };
 
     inline int get_dim_from_binary(string filename)
     {
@@ -120,16 +166,22 @@ namespace H2ONaCl
 
     struct PROP_H2ONaCl
     {
-        PhaseRegion Region;
-        double T, H, Rho, Mu; //temperature(C), bulk enthalpy, bulk density
-        double Rho_l, Rho_v, Rho_h; //density
-        double H_l, H_v, H_h; //enthalpy
-        double S_l, S_v, S_h; //saturation
+        PhaseRegion Region; 
+        double T, P, X_wt, H, Cp, Rho, Mu; /**< temperature(C), P(Pa), X_wt(wt%),bulk enthalpy [J/kg], bulk specific heat [J/kg/K], bulk density [kg/m3], viscosity [Pa s] */
+        double Rho_l, Rho_v, Rho_h; //density [kg/m3]
+        double H_l, H_v, H_h; //enthalpy [J/kg]
+        double Cp_l, Cp_v, Cp_h;
+        double S_l, S_v, S_h; //saturation [-]
         double X_l, X_v; // volume fraction of NaCl in vaper and liquid, it is a composition fraction. H2O + NaCl
-        double Mu_l, Mu_v;//viscosity
-        // derivertive
-        // double dS_hdh, dS_vdh, dS_ldh, dRhodh;
+        double Mu_l, Mu_v;//viscosity [Pa s]
+        // derivatives
+        double dRhodH;
     };
+    
+    /// Members of PROP_H2ONaCl in the column order of cH2ONaCl::prop_columns, the column names are the member names, see cH2ONaCl::getPropColumnName
+    enum PROP_COLUMN {Column_T, Column_P, Column_X_wt, Column_H, Column_Cp, Column_Rho, Column_Mu, 
+                      Column_Rho_l, Column_Rho_v, Column_Rho_h, Column_H_l, Column_H_v, Column_H_h, Column_Cp_l, Column_Cp_v, Column_Cp_h, 
+                      Column_S_l, Column_S_v, Column_S_h, Column_X_l, Column_X_v, Column_Mu_l, Column_Mu_v, Column_dRhodH, NUM_PROP_COLUMNS};
 
     struct MP_STRUCT
     {
@@ -234,6 +286,7 @@ namespace H2ONaCl
         H2ONaCl::MAP_PHASE_REGION m_phaseRegion_name;
         H2ONaCl::PROP_H2ONaCl m_prop;
         inline string getPhaseRegionName(PhaseRegion regionID){return m_phaseRegion_name[regionID];};
+        string getPropColumnName(int column); /**< Name of H2ONaCl::PROP_COLUMN, the member name of PROP_H2ONaCl */
         /**
          * @brief Calculate thermal dynamic properties of NaCl-H2O system.
          * 
@@ -494,9 +547,9 @@ namespace H2ONaCl
         int m_dim_lut;
         void *m_pLUT;
         //void createLUT_2D_TPX(double xy_min[2], double xy_max[2], double constZ, LOOKUPTABLE_FOREST::CONST_WHICH_VAR const_which_var, LOOKUPTABLE_FOREST::EOS_ENERGY TorH, int min_level = 4, int max_level = 6);
-        void createLUT_2D(double xmin, double xmax, double ymin, double ymax, double constZ, LOOKUPTABLE_FOREST::CONST_WHICH_VAR const_which_var, LOOKUPTABLE_FOREST::EOS_ENERGY TorH, int min_level = 4, int max_level = 6);
+        void createLUT_2D(double xmin, double xmax, double ymin, double ymax, double constZ, LOOKUPTABLE_FOREST::CONST_WHICH_VAR const_which_var, LOOKUPTABLE_FOREST::EOS_ENERGY TorH, int min_level = 4, int max_level = 6, int update_which_props=0);
         //void createLUT_3D_TPX(double xyz_min[3], double xyz_max[3], LOOKUPTABLE_FOREST::EOS_ENERGY TorH, int min_level = 4, int max_level = 6);
-        void createLUT_3D(double xmin, double xmax, double ymin, double ymax, double zmin, double zmax, LOOKUPTABLE_FOREST::EOS_ENERGY TorH, int min_level = 4, int max_level = 6);
+        void createLUT_3D(double xmin, double xmax, double ymin, double ymax, double zmin, double zmax, LOOKUPTABLE_FOREST::EOS_ENERGY TorH, int min_level = 4, int max_level = 6, int update_which_props=0);
         H2ONaCl::PROP_H2ONaCl lookup(double x, double y); //for python API
         H2ONaCl::PROP_H2ONaCl lookup(double x, double y, double z); //for python API
         void destroyLUT();
@@ -504,7 +557,10 @@ namespace H2ONaCl
         LookUpTableForest_2D* cH2ONaCl::getLUT_2D();
         LookUpTableForest_3D* getLUT_3D(); //for Python API
         void save_lut_to_vtk(string filename);
+        void save_lut_to_vtu(string filename, LOOKUPTABLE_FOREST::VTU_FORMAT format=LOOKUPTABLE_FOREST::VTU_FORMAT_RAW, bool compress=false);
+        void save_lut_to_pvtu(string filename, int num_pieces, LOOKUPTABLE_FOREST::VTU_FORMAT format=LOOKUPTABLE_FOREST::VTU_FORMAT_RAW, bool compress=false);
         void save_lut_to_binary(string filename);
+        void save_lut_to_single_binary(string filename);
     private:
         inline double Xwt2Xmol(double X){return (X/NaCl::MolarMass)/(X/NaCl::MolarMass+(1-X)/H2O::MolarMass);};
         void approx_Rho_lv(double T, double& Rho_l , double& Rho_v);
@@ -550,3 +606,169 @@ namespace H2ONaCl
         void writeVTK_Quads(string filename, vector<vector<double> > X, vector<vector<double> > Y, vector<vector<double> > Z, double scale_X=1.0, double scale_Y=1.0, double scale_Z=1.0, bool includeTwoEndsPolygon=true);
     };
 }
+
+#ifdef SWIGPYTHON
+// ===== Vectorized Python API: arrays in, dict of NumPy columns out. The arrays are evaluated in C++ (in parallel with OpenMP) with the GIL released =====
+%extend H2ONaCl::cH2ONaCl
+{
+    /**
+     * @brief Fill the property columns of arrays of (p, T or H, X), see prop_pTX_array and prop_pHX_array.
+     * 
+     * @param columns Sequence of NUM_PROP_COLUMNS float64 arrays, a None column is not calculated
+     * @param region int32 array of phase region, or None
+     */
+    PyObject* _prop_columns(PyObject* p, PyObject* TorH, PyObject* X_wt, int TorH_type, PyObject* columns, PyObject* region)
+    {
+        Py_ssize_t num_points = PyObject_Length(p);
+        if(num_points < 0)return NULL;
+        if(num_points > INT_MAX)return PyErr_Format(PyExc_ValueError, "Too many points: %zd", num_points);
+        ArrayViews views;
+        const double* p_data = (const double*)views.get(p, 'd', false, num_points);
+        const double* TorH_data = p_data ? (const double*)views.get(TorH, 'd', false, num_points) : NULL;
+        const double* X_data = TorH_data ? (const double*)views.get(X_wt, 'd', false, num_points) : NULL;
+        if(!X_data)return NULL;
+        PyObject* seq = PySequence_Fast(columns, "The property columns must be a sequence");
+        if(!seq)return NULL;
+        if(PySequence_Fast_GET_SIZE(seq) != H2ONaCl::NUM_PROP_COLUMNS)
+        {
+            Py_DECREF(seq);
+            return PyErr_Format(PyExc_ValueError, "Expect %d property columns", (int)H2ONaCl::NUM_PROP_COLUMNS);
+        }
+        double* pColumns[H2ONaCl::NUM_PROP_COLUMNS];
+        for (int j = 0; j < H2ONaCl::NUM_PROP_COLUMNS; j++)
+        {
+            PyObject* column = PySequence_Fast_GET_ITEM(seq, j);
+            pColumns[j] = column == Py_None ? NULL : (double*)views.get(column, 'd', true, num_points);
+            if(column != Py_None && !pColumns[j])
+            {
+                Py_DECREF(seq);
+                return NULL;
+            }
+        }
+        Py_DECREF(seq); //the columns are referenced by their buffers
+        H2ONaCl::PhaseRegion* region_data = NULL;
+        if(region != Py_None && !(region_data = (H2ONaCl::PhaseRegion*)views.get(region, 'i', true, num_points)))return NULL;
+        Py_BEGIN_ALLOW_THREADS
+        $self->prop_columns((int)num_points, p_data, TorH_data, X_data, (LOOKUPTABLE_FOREST::EOS_ENERGY)TorH_type, pColumns, region_data);
+        Py_END_ALLOW_THREADS
+        Py_RETURN_NONE;
+    }
+    /**
+     * @brief Look up arrays of points in the LUT, the points in the leaves which need refine are calculated by the EOS, see lookup_array.
+     * 
+     * @param z None for a 2D LUT
+     * @param columns Sequence of float64 arrays, one for each property of the LUT
+     * @return Number of points calculated by the EOS
+     */
+    PyObject* _lookup_columns(PyObject* x, PyObject* y, PyObject* z, PyObject* columns, PyObject* region)
+    {
+        if($self->m_dim_lut != 2 && $self->m_dim_lut != 3)return PyErr_Format(PyExc_RuntimeError, "No LUT is created or loaded");
+        if(($self->m_dim_lut == 3) == (z == Py_None))return PyErr_Format(PyExc_ValueError, "z must be given for a 3D LUT and only for a 3D LUT");
+        Py_ssize_t num_points = PyObject_Length(x);
+        if(num_points < 0)return NULL;
+        if(num_points > INT_MAX)return PyErr_Format(PyExc_ValueError, "Too many points: %zd", num_points);
+        ArrayViews views;
+        const double* x_data = (const double*)views.get(x, 'd', false, num_points);
+        const double* y_data = x_data ? (const double*)views.get(y, 'd', false, num_points) : NULL;
+        if(!y_data)return NULL;
+        const double* z_data = NULL;
+        if(z != Py_None && !(z_data = (const double*)views.get(z, 'd', false, num_points)))return NULL;
+        const size_t num_props = $self->m_dim_lut == 2 ? ((H2ONaCl::LookUpTableForest_2D*)$self->m_pLUT)->m_map_props.size() : ((H2ONaCl::LookUpTableForest_3D*)$self->m_pLUT)->m_map_props.size();
+        // the lookup exits the program for a point out of the LUT range, so the range is checked here
+        const double* xyz_min = $self->m_dim_lut == 2 ? ((H2ONaCl::LookUpTableForest_2D*)$self->m_pLUT)->m_xyz_min : ((H2ONaCl::LookUpTableForest_3D*)$self->m_pLUT)->m_xyz_min;
+        const double* xyz_max = $self->m_dim_lut == 2 ? ((H2ONaCl::LookUpTableForest_2D*)$self->m_pLUT)->m_xyz_max : ((H2ONaCl::LookUpTableForest_3D*)$self->m_pLUT)->m_xyz_max;
+        for (Py_ssize_t i = 0; i < num_points; i++)
+        {
+            if(!(x_data[i] >= xyz_min[0] && x_data[i] <= xyz_max[0] && y_data[i] >= xyz_min[1] && y_data[i] <= xyz_max[1] && (!z_data || (z_data[i] >= xyz_min[2] && z_data[i] <= xyz_max[2]))))
+            {
+                char msg[256];
+                if(z_data)snprintf(msg, sizeof(msg), "The lookup point %zd is out of the LUT range: (%g, %g, %g)", i, x_data[i], y_data[i], z_data[i]);
+                else snprintf(msg, sizeof(msg), "The lookup point %zd is out of the LUT range: (%g, %g)", i, x_data[i], y_data[i]);
+                PyErr_SetString(PyExc_ValueError, msg);
+                return NULL;
+            }
+        }
+        PyObject* seq = PySequence_Fast(columns, "The property columns must be a sequence");
+        if(!seq)return NULL;
+        if((size_t)PySequence_Fast_GET_SIZE(seq) != num_props)
+        {
+            Py_DECREF(seq);
+            return PyErr_Format(PyExc_ValueError, "Expect %d property columns", (int)num_props);
+        }
+        std::vector<double*> pColumns(num_props);
+        for (size_t j = 0; j < num_props; j++)
+        {
+            if(!(pColumns[j] = (double*)views.get(PySequence_Fast_GET_ITEM(seq, j), 'd', true, num_points)))
+            {
+                Py_DECREF(seq);
+                return NULL;
+            }
+        }
+        Py_DECREF(seq);
+        H2ONaCl::PhaseRegion* region_data = NULL;
+        if(region != Py_None && !(region_data = (H2ONaCl::PhaseRegion*)views.get(region, 'i', true, num_points)))return NULL;
+        int num_cal = 0;
+        Py_BEGIN_ALLOW_THREADS
+        num_cal = $self->lookup_batch_cal((int)num_points, x_data, y_data, z_data, pColumns.data(), region_data);
+        Py_END_ALLOW_THREADS
+        return PyLong_FromLong(num_cal);
+    }
+    /**
+     * @brief Short names of the properties of the LUT, in the order of the columns of _lookup_columns.
+     */
+    std::vector<std::string> _lut_prop_names()
+    {
+        std::vector<std::string> names;
+        if($self->m_dim_lut != 2 && $self->m_dim_lut != 3)return names;
+        std::map<int, propInfo>& map_props = $self->m_dim_lut == 2 ? ((H2ONaCl::LookUpTableForest_2D*)$self->m_pLUT)->m_map_props : ((H2ONaCl::LookUpTableForest_3D*)$self->m_pLUT)->m_map_props;
+        for (auto &m : map_props)names.push_back(m.second.shortName);
+        return names;
+    }
+%pythoncode %{
+    def prop_pTX_array(self, p, T_K, X_wt, props=None):
+        """Properties of arrays of points, the arrays are broadcast against each other.
+
+        p: pressure [Pa], T_K: temperature [K], X_wt: salinity [mass fraction]
+        props: names of the properties to calculate (see getPropColumnName), default is all
+        return: dict of NumPy arrays with the shape of the points, the name of each property column and 'Region' (int32)
+        """
+        return self._prop_array(p, T_K, X_wt, EOS_ENERGY_T, props)
+
+    def prop_pHX_array(self, p, H, X_wt, props=None):
+        """Properties of arrays of points, the same as prop_pTX_array but with specific enthalpy H [J/kg]."""
+        return self._prop_array(p, H, X_wt, EOS_ENERGY_H, props)
+
+    def _prop_array(self, p, TorH, X_wt, TorH_type, props):
+        import numpy as np
+        arrays = np.broadcast_arrays(p, TorH, X_wt)
+        shape = arrays[0].shape
+        # no copy if the array is already contiguous float64
+        p, TorH, X_wt = [np.ascontiguousarray(a, dtype=np.float64).ravel() for a in arrays]
+        names = [self.getPropColumnName(j) for j in range(NUM_PROP_COLUMNS)]
+        columns = [np.empty(p.size) if (props is None or name in props) else None for name in names]
+        region = np.empty(p.size, dtype=np.int32)
+        self._prop_columns(p, TorH, X_wt, TorH_type, columns, region)
+        result = {name: column.reshape(shape) for name, column in zip(names, columns) if column is not None}
+        result['Region'] = region.reshape(shape)
+        return result
+
+    def lookup_array(self, x, y, z=None):
+        """Look up arrays of points in the created or loaded LUT, z is only given for a 3D LUT. 
+        The points in the leaves which need refine are calculated by the EOS.
+
+        return: dict of NumPy arrays with the shape of the points, the short name of each LUT property and 'Region' (int32)
+        """
+        import numpy as np
+        arrays = np.broadcast_arrays(x, y) if z is None else np.broadcast_arrays(x, y, z)
+        shape = arrays[0].shape
+        arrays = [np.ascontiguousarray(a, dtype=np.float64).ravel() for a in arrays]
+        names = self._lut_prop_names()
+        columns = [np.empty(arrays[0].size) for name in names]
+        region = np.empty(arrays[0].size, dtype=np.int32)
+        self._lookup_columns(arrays[0], arrays[1], None if z is None else arrays[2], columns, region)
+        result = {name: column.reshape(shape) for name, column in zip(names, columns)}
+        result['Region'] = region.reshape(shape)
+        return result
+%}
+}
+#endif
@@ -60,9 +60,31 @@ def test_LUT_load_lookup():
     stop = time.process_time()
     print("Search, elapsed time: %.2f, %d need refine" % (stop - start, ind))
 
+def test_array_API():
+    # 7. vectorized API: NumPy arrays in, dict of property columns out, the points are evaluated in C++ without the GIL
+    n = int(1E5)
+    p = np.random.uniform(5E5, 400E5, n) # Pa
+    T_K = np.random.uniform(1, 700, n) + 273.15
+    X_wt = 0.2 # scalars are broadcast
+    start = time.time()
+    props = sw.prop_pTX_array(p, T_K, X_wt)
+    print("prop_pTX_array of %d points, elapsed time: %.2f s" % (n, time.time() - start))
+    prop = sw.prop_pTX(p[0], T_K[0], X_wt)
+    print(props['Rho'][0], prop.Rho, props['Region'][0], prop.Region)
+    # only some of the properties, p and H of a 2D grid
+    P, H = np.meshgrid(np.linspace(5E5, 400E5, 100), np.linspace(1E5, 3.5E6, 100))
+    props = sw.prop_pHX_array(P, H, X_wt, props=['T', 'Rho', 'S_l'])
+    print(props['T'].shape, sorted(props.keys()))
+    # lookup table
+    update_which_props = 2 | 4 # Update_prop_rho | Update_prop_h
+    sw.createLUT_2D(1 + 273.15, 700 + 273.15, 5E5, 400E5, X_wt, H2ONaCl.CONST_X_VAR_TorHP, H2ONaCl.EOS_ENERGY_T, 4, 6, update_which_props)
+    props = sw.lookup_array(T_K, p)
+    print(sorted(props.keys()))
+    sw.destroyLUT()
 
 # run test
 # test_basic()
 # test_propCalculation()
 # test_LUT_generation()
+# test_array_API()
 test_LUT_load()
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "H2ONaCl.H"
+#include "interpolationI.H"
+#include "LookUpTableForestI.H"
 #include <iostream>
 H2ONaCl::cH2ONaCl eos;
 
@@ -575,6 +577,1175 @@ void load_binary_2d(string filename, bool isCal)
 
     STATUS_time("Searching done", clock() - start);
 }
+int compare_linear_tree_storage(int max_level)
+{
+    int num_fail = 0;
+    const int dim = 2;
+    double TP_min[2] = {1 + 273.15, 5E5}; //T [K], P[Pa]
+    double TP_max[2] = {700 + 273.15, 400E5};
+    double X_wt = 0.2;
+    int min_level = 4;
+    int update_props = Update_prop_rho | Update_prop_h;
+    H2ONaCl::cH2ONaCl eos_tree, eos_linear, eos_load;
+    eos_tree.createLUT_2D(TP_min, TP_max, X_wt, LOOKUPTABLE_FOREST::CONST_X_VAR_TorHP, LOOKUPTABLE_FOREST::EOS_ENERGY_T, min_level, max_level, update_props);
+    eos_linear.set_lut_storage(LOOKUPTABLE_FOREST::LUT_STORAGE_LINEAR);
+    eos_linear.createLUT_2D(TP_min, TP_max, X_wt, LOOKUPTABLE_FOREST::CONST_X_VAR_TorHP, LOOKUPTABLE_FOREST::EOS_ENERGY_T, min_level, max_level, update_props);
+    // the binary file written by the linear forest must be the same as the one written by the pointer-based forest, so it can be loaded by either storage.
+    eos_linear.save_lut_to_binary("lut_linear_"+std::to_string(max_level)+".bin");
+    eos_load.set_lut_storage(LOOKUPTABLE_FOREST::LUT_STORAGE_LINEAR);
+    eos_load.loadLUT("lut_linear_"+std::to_string(max_level)+".bin");
+    H2ONaCl::LookUpTableForest_2D* pLUT_tree = eos_tree.getLUT_2D();
+    H2ONaCl::LookUpTableForest_2D* pLUT_linear = eos_linear.getLUT_2D();
+    if(pLUT_tree->m_props_unique_points_leaves.num_points != pLUT_linear->m_props_unique_points_leaves.num_points)
+    {
+        cout<<"Number of unique points is different: "<<pLUT_tree->m_props_unique_points_leaves.num_points<<" vs "<<pLUT_linear->m_props_unique_points_leaves.num_points<<endl;
+        num_fail++;
+    }
+    int num_props = pLUT_tree->m_map_props.size();
+    double* props_tree = new double[num_props];
+    double* props_linear = new double[num_props];
+    double* props_load = new double[num_props];
+    double xyz_min_tree[dim], xyz_min_linear[dim], xyz_min_load[dim];
+    int n_randSample = 1E4;
+    for (int i = 0; i < n_randSample; i++)
+    {
+        double T_K = (rand()/(double)RAND_MAX)*(TP_max[0] - TP_min[0]) + TP_min[0];
+        double p_Pa = (rand()/(double)RAND_MAX)*(TP_max[1] - TP_min[1]) + TP_min[1];
+        eos_tree.lookup(props_tree, xyz_min_tree, T_K, p_Pa, false);
+        eos_linear.lookup(props_linear, xyz_min_linear, T_K, p_Pa, false);
+        eos_load.lookup(props_load, xyz_min_load, T_K, p_Pa, false);
+        for (int j = 0; j < num_props; j++)
+        {
+            if(fabs(props_tree[j] - props_linear[j]) > 1E-8*fabs(props_tree[j]) || props_linear[j] != props_load[j])
+            {
+                cout<<"Lookup result is different at T="<<T_K<<" K, p="<<p_Pa<<" Pa: "<<props_tree[j]<<", "<<props_linear[j]<<", "<<props_load[j]<<endl;
+                num_fail++;
+                break;
+            }
+        }
+    }
+    delete[] props_tree;
+    delete[] props_linear;
+    delete[] props_load;
+    if(num_fail==0)STATUS("Linear forest and pointer-based forest give the same result.");
+    return num_fail;
+}
+int compare_lookup_batch(int max_level)
+{
+    int num_fail = 0;
+    double TPX_min[3] = {1 + 273.15, 5E5, 0.001}; //T [K], P[Pa], X [wt]
+    double TPX_max[3] = {700 + 273.15, 400E5, 0.4};
+    int min_level = 3;
+    H2ONaCl::cH2ONaCl eos;
+    eos.createLUT_3D(TPX_min, TPX_max, LOOKUPTABLE_FOREST::EOS_ENERGY_T, min_level, max_level, Update_prop_rho | Update_prop_h);
+    int num_props = eos.getLUT_3D()->m_map_props.size();
+    int n_randSample = 1E4;
+    vector<double> T_K(n_randSample), p_Pa(n_randSample), X_wt(n_randSample);
+    for (int i = 0; i < n_randSample; i++)
+    {
+        T_K[i] = (rand()/(double)RAND_MAX)*(TPX_max[0] - TPX_min[0]) + TPX_min[0];
+        p_Pa[i] = (rand()/(double)RAND_MAX)*(TPX_max[1] - TPX_min[1]) + TPX_min[1];
+        X_wt[i] = (rand()/(double)RAND_MAX)*(TPX_max[2] - TPX_min[2]) + TPX_min[2];
+    }
+    vector<vector<double> > props_batch(num_props, vector<double>(n_randSample));
+    vector<double*> pProps(num_props);
+    for (int j = 0; j < num_props; j++)pProps[j] = props_batch[j].data();
+    vector<H2ONaCl::PhaseRegion> phaseRegion(n_randSample);
+    vector<LOOKUPTABLE_FOREST::NeedRefine> need_refine(n_randSample);
+    clock_t start = clock();
+    eos.lookup_batch(n_randSample, T_K.data(), p_Pa.data(), X_wt.data(), pProps.data(), phaseRegion.data(), need_refine.data());
+    STATUS_time("Batch lookup done", clock() - start);
+    // the single point lookup of a linear LUT returns no quadrant, so the need-refine indicator is compared through the out-parameter
+    string filename = "lut_batch_"+std::to_string(max_level)+".bin";
+    eos.save_lut_to_binary(filename);
+    H2ONaCl::cH2ONaCl eos_linear;
+    eos_linear.set_lut_storage(LOOKUPTABLE_FOREST::LUT_STORAGE_LINEAR);
+    eos_linear.loadLUT(filename);
+    double* props = new double[num_props];
+    double* props_linear = new double[num_props];
+    double xyz_min_target[3];
+    for (int i = 0; i < n_randSample; i++)
+    {
+        eos.lookup(props, xyz_min_target, T_K[i], p_Pa[i], X_wt[i], false);
+        eos_linear.lookup(props_linear, xyz_min_target, T_K[i], p_Pa[i], X_wt[i], false);
+        H2ONaCl::PROP_H2ONaCl prop, prop_linear;
+        LOOKUPTABLE_FOREST::NeedRefine need_refine_single, need_refine_linear;
+        eos.lookup_only(prop, T_K[i], p_Pa[i], X_wt[i], &need_refine_single);
+        eos_linear.lookup_only(prop_linear, T_K[i], p_Pa[i], X_wt[i], &need_refine_linear);
+        bool isSame = (prop.Region == phaseRegion[i]) && (need_refine_single == need_refine[i]);
+        isSame = isSame && (prop_linear.Region == phaseRegion[i]) && (need_refine_linear == need_refine[i]);
+        for (int j = 0; j < num_props; j++)isSame = isSame && (props[j] == props_batch[j][i]) && (props_linear[j] == props_batch[j][i]);
+        if(!isSame)
+        {
+            cout<<"Batch lookup result is different at T="<<T_K[i]<<" K, p="<<p_Pa[i]<<" Pa, X="<<X_wt[i]<<endl;
+            num_fail++;
+        }
+    }
+    delete[] props;
+    delete[] props_linear;
+    if(num_fail==0)STATUS("Batch lookup and single point lookup give the same result.");
+    return num_fail;
+}
+int compare_single_binary(int max_level)
+{
+    int num_fail = 0;
+    const int dim = 2;
+    double TP_min[2] = {1 + 273.15, 5E5}; //T [K], P[Pa]
+    double TP_max[2] = {700 + 273.15, 400E5};
+    double X_wt = 0.2;
+    int min_level = 4;
+    int update_props = Update_prop_rho | Update_prop_h;
+    string filename = "lut_single_"+std::to_string(max_level)+".bin";
+    H2ONaCl::cH2ONaCl eos;
+    eos.createLUT_2D(TP_min, TP_max, X_wt, LOOKUPTABLE_FOREST::CONST_X_VAR_TorHP, LOOKUPTABLE_FOREST::EOS_ENERGY_T, min_level, max_level, update_props);
+    eos.save_lut_to_single_binary(filename);
+    // the single file can be loaded by all storage types
+    const int num_storage = 3;
+    LOOKUPTABLE_FOREST::LUT_STORAGE storages[num_storage] = {LOOKUPTABLE_FOREST::LUT_STORAGE_TREE, LOOKUPTABLE_FOREST::LUT_STORAGE_LINEAR, LOOKUPTABLE_FOREST::LUT_STORAGE_MMAP};
+    H2ONaCl::cH2ONaCl eos_load[num_storage];
+    for (int i = 0; i < num_storage; i++)
+    {
+        eos_load[i].set_lut_storage(storages[i]);
+        eos_load[i].loadLUT(filename);
+        if(eos_load[i].getLUT_2D()->m_props_unique_points_leaves.num_points != eos.getLUT_2D()->m_props_unique_points_leaves.num_points)
+        {
+            cout<<"Number of unique points is different for storage "<<storages[i]<<endl;
+            num_fail++;
+        }
+    }
+    int num_props = eos.getLUT_2D()->m_map_props.size();
+    double* props = new double[num_props];
+    double* props_load = new double[num_props];
+    double xyz_min[dim], xyz_min_load[dim];
+    int n_randSample = 1E4;
+    for (int i = 0; i < n_randSample; i++)
+    {
+        double T_K = (rand()/(double)RAND_MAX)*(TP_max[0] - TP_min[0]) + TP_min[0];
+        double p_Pa = (rand()/(double)RAND_MAX)*(TP_max[1] - TP_min[1]) + TP_min[1];
+        eos.lookup(props, xyz_min, T_K, p_Pa, false);
+        for (int k = 0; k < num_storage; k++)
+        {
+            eos_load[k].lookup(props_load, xyz_min_load, T_K, p_Pa, false);
+            for (int j = 0; j < num_props; j++)
+            {
+                if(props[j] != props_load[j])
+                {
+                    cout<<"Lookup result of storage "<<storages[k]<<" is different at T="<<T_K<<" K, p="<<p_Pa<<" Pa: "<<props[j]<<", "<<props_load[j]<<endl;
+                    num_fail++;
+                    break;
+                }
+            }
+        }
+    }
+    delete[] props;
+    delete[] props_load;
+    // the data is only verified on request, a corrupted property is detected by verify_single_binary
+    if(!LOOKUPTABLE_FOREST::verify_single_binary(filename))
+    {
+        cout<<"Verification of the single-file LUT failed: "<<filename<<endl;
+        num_fail++;
+    }
+    LOOKUPTABLE_FOREST::LUTFileHeader header;
+    FILE* fp = fopen(filename.c_str(), "r+b");
+    fread(&header, sizeof(header), 1, fp);
+    fseek(fp, header.offset_props + sizeof(double), SEEK_SET);
+    double value = -1;
+    fwrite(&value, sizeof(double), 1, fp);
+    fclose(fp);
+    if(LOOKUPTABLE_FOREST::verify_single_binary(filename))
+    {
+        cout<<"Corrupted properties are not detected by verify_single_binary: "<<filename<<endl;
+        num_fail++;
+    }
+    if(num_fail==0)STATUS("Single-file LUT gives the same result for all storage types.");
+    return num_fail;
+}
+int compare_shared_eos(int num_points)
+{
+    int num_fail = 0;
+    vector<double> T_K(num_points), p_Pa(num_points), X_wt(num_points);
+    for (int i = 0; i < num_points; i++)
+    {
+        T_K[i] = (rand()/(double)RAND_MAX)*(1000 - 1) + 1 + 273.15;
+        p_Pa[i] = (rand()/(double)RAND_MAX)*(2000E5 - 5E5) + 5E5;
+        X_wt[i] = (rand()/(double)RAND_MAX)*(1 - 0.001) + 0.001;
+    }
+    // one instance shared by all threads
+    H2ONaCl::cH2ONaCl eos;
+    vector<H2ONaCl::PROP_H2ONaCl> props(num_points);
+    clock_t start = clock();
+#if USE_OMP == 1
+    #pragma omp parallel for shared(eos, props)
+#endif
+    for (int i = 0; i < num_points; i++)
+    {
+        props[i] = eos.prop_pTX(p_Pa[i], T_K[i], X_wt[i]);
+    }
+    STATUS_time("Shared instance done", clock() - start);
+    for (int i = 0; i < num_points; i++)
+    {
+        H2ONaCl::cH2ONaCl eos_point;
+        H2ONaCl::PROP_H2ONaCl prop = eos_point.prop_pTX(p_Pa[i], T_K[i], X_wt[i]);
+        bool isSame = (prop.Region == props[i].Region);
+        isSame = isSame && ((prop.Rho == props[i].Rho) || (std::isnan(prop.Rho) && std::isnan(props[i].Rho)));
+        isSame = isSame && ((prop.H == props[i].H) || (std::isnan(prop.H) && std::isnan(props[i].H)));
+        isSame = isSame && ((prop.Mu == props[i].Mu) || (std::isnan(prop.Mu) && std::isnan(props[i].Mu)));
+        if(!isSame)
+        {
+            cout<<"Result of the shared instance is different at T="<<T_K[i]<<" K, p="<<p_Pa[i]<<" Pa, X="<<X_wt[i]<<endl;
+            num_fail++;
+        }
+    }
+    if(num_fail==0)STATUS("Shared instance and per-point instances give the same result.");
+    return num_fail;
+}
+int compare_water_density(int num_points)
+{
+    int num_fail = 0;
+    H2O::cH2O water;
+    vector<double> T(num_points), P(num_points), Rho_newton(num_points), Rho_bisection(num_points);
+    for (int i = 0; i < num_points; i++)
+    {
+        T[i] = (rand()/(double)RAND_MAX)*(H2O::TMAX - H2O::TMIN) + H2O::TMIN; //deg.C
+        P[i] = exp((rand()/(double)RAND_MAX)*log(H2ONaCl::PMAX)); //bar, [1, PMAX]
+    }
+    clock_t start = clock();
+    for (int i = 0; i < num_points; i++)Rho_newton[i] = water.Rho(T[i], P[i]);
+    STATUS_time("Newton iteration done", clock() - start);
+    start = clock();
+    for (int i = 0; i < num_points; i++)Rho_bisection[i] = water.Rho_Bisection(T[i], P[i]);
+    STATUS_time("Bisection iteration done", clock() - start);
+    for (int i = 0; i < num_points; i++)
+    {
+        double residual = fabs(water.Pressure_T_Rho(T[i], Rho_newton[i]) - P[i])/P[i];
+        if(!(residual < 1E-8) || !(fabs(Rho_newton[i] - Rho_bisection[i]) < 1E-5))
+        {
+            cout<<"Water density is different at T="<<T[i]<<" C, P="<<P[i]<<" bar: "<<Rho_newton[i]<<", "<<Rho_bisection[i]<<endl;
+            num_fail++;
+        }
+    }
+    if(num_fail==0)STATUS("Newton and bisection iteration give the same water density.");
+    return num_fail;
+}
+int check_water_state(int num_points)
+{
+    int num_fail = 0;
+    H2O::cH2O water;
+    vector<double> T(num_points), P(num_points);
+    for (int i = 0; i < num_points; i++)
+    {
+        T[i] = (rand()/(double)RAND_MAX)*(H2O::TMAX - H2O::TMIN) + H2O::TMIN; //deg.C
+        P[i] = exp((rand()/(double)RAND_MAX)*log(H2ONaCl::PMAX)); //bar, [1, PMAX]
+    }
+    vector<H2O::WaterState> states(num_points);
+    clock_t start = clock();
+    water.State(num_points, T.data(), P.data(), states.data());
+    STATUS_time("Water state of "+to_string(num_points)+" points done", clock() - start);
+    for (int i = 0; i < num_points; i++)
+    {
+        H2O::WaterState& state = states[i];
+        bool isSame = state.Rho == water.Rho(T[i], P[i]) && state.H == water.SpecificEnthalpy(T[i], P[i]) && state.Cv == water.Cv(T[i], P[i]) 
+                      && state.Cp == water.Cp(T[i], P[i]) && state.Mu == water.mu(T[i], P[i]);
+        // central differences of the density with a relative step
+        double dP = P[i]*1E-5, dT = 1E-4;
+        double beta = (water.Rho(T[i], P[i] + dP) - water.Rho(T[i], P[i] - dP))/(2*dP)/state.Rho*1E-5;
+        double alpha = -(water.Rho(T[i] + dT, P[i]) - water.Rho(T[i] - dT, P[i]))/(2*dT)/state.Rho;
+        // the density jumps across the boiling curve
+        bool isBoiling = T[i] < H2O::T_Critic && fabs(P[i] - water.P_Boiling(T[i])) < 1E-3*P[i];
+        if(!isBoiling)isSame = isSame && fabs(state.beta - beta) < 1E-4*fabs(beta) && fabs(state.alpha - alpha) < 1E-4*fabs(alpha);
+        if(!isSame)
+        {
+            cout<<"Water state is different at T="<<T[i]<<" C, P="<<P[i]<<" bar: alpha "<<state.alpha<<", "<<alpha<<"; beta "<<state.beta<<", "<<beta<<endl;
+            num_fail++;
+        }
+    }
+    if(num_fail==0)STATUS("Water state gives the same properties as the single property functions.");
+    return num_fail;
+}
+/**
+ * @brief Roots of the V+L+H pressure polynomial by Jenkins-Traub, as cH2ONaCl::T_VaporLiquidHaliteCoexist used to be
+ * 
+ */
+vector<double> T_VLH_FindRoots(double P)
+{
+    const int degree = 10;
+    double f[11] = {0.00464, 5E-07, 16.9078, -269.148, 7632.04, -49563.6, 233119.0, -513556.0, 549708.0, -284628.0, NaCl::P_Triple};
+    for (int i = 0; i < 10; i++)f[10] -= f[i];
+    f[0] -= P;
+    double real_roots[degree], imag_roots[degree];
+    int root_count = 0;
+    Polynomial polynomial;
+    polynomial.SetCoefficients(f, degree);
+    vector<double> roots_T;
+    if(polynomial.FindRoots(real_roots, imag_roots, &root_count) == PolynomialRootFinder::SUCCESS)
+    {
+        for (int i = 0; i < root_count; i++)
+        {
+            double root_T = real_roots[i]*NaCl::T_Triple;
+            if(imag_roots[i]==0 && root_T>=H2ONaCl::TMIN_C && root_T<=H2ONaCl::TMAX_C)roots_T.push_back(root_T);
+        }
+    }
+    std::sort(roots_T.begin(), roots_T.end());
+    return roots_T;
+}
+/**
+ * @brief Root of P_VaporLiquidHaliteCoexist(T) = P in [T_lo, T_hi] by bisection, P_VLH(T) is monotone in the bracket
+ * 
+ */
+double T_VLH_Bisection(H2ONaCl::cH2ONaCl& eos, double P, double T_lo, double T_hi)
+{
+    bool isIncreasing = eos.P_VaporLiquidHaliteCoexist(T_lo) < eos.P_VaporLiquidHaliteCoexist(T_hi);
+    for (int iter = 0; iter < 100; iter++)
+    {
+        double T = 0.5*(T_lo + T_hi);
+        if((eos.P_VaporLiquidHaliteCoexist(T) < P) == isIncreasing)T_lo = T;
+        else T_hi = T;
+    }
+    return 0.5*(T_lo + T_hi);
+}
+int check_T_VLH(int num_points)
+{
+    int num_fail = 0;
+    H2ONaCl::cH2ONaCl eos;
+    double T_Pmax, Pmax;
+    eos.Pmax_VaporLiquidHaliteCoexist(T_Pmax, Pmax);
+    if(!(fabs(Pmax - 390.147) < 1E-3) || !(eos.P_VaporLiquidHaliteCoexist(T_Pmax - 1E-2) < Pmax && eos.P_VaporLiquidHaliteCoexist(T_Pmax + 1E-2) < Pmax))
+    {
+        cout<<"The maximum pressure of V+L+H is wrong: T="<<T_Pmax<<" C, P="<<Pmax<<" bar"<<endl;
+        num_fail++;
+    }
+    // both branches end at T_Pmax, so P == Pmax has a single root
+    vector<double> roots_Pmax = eos.T_VaporLiquidHaliteCoexist(Pmax);
+    if(roots_Pmax.size() != 1 || !(fabs(roots_Pmax[0] - T_Pmax) < 1E-8))
+    {
+        cout<<"T_VLH is wrong at Pmax="<<Pmax<<" bar: "<<roots_Pmax.size()<<" roots";
+        for (size_t j = 0; j < roots_Pmax.size(); j++)cout<<" "<<roots_Pmax[j];
+        cout<<endl;
+        num_fail++;
+    }
+    vector<double> P(num_points);
+    for (int i = 0; i < num_points; i++)P[i] = (rand()/(double)RAND_MAX)*(Pmax - 1E-6); //bar
+    vector<vector<double> > roots_newton(num_points), roots_findroots(num_points);
+    clock_t start = clock();
+    for (int i = 0; i < num_points; i++)roots_newton[i] = eos.T_VaporLiquidHaliteCoexist(P[i]);
+    STATUS_time("Newton iteration of T_VLH done", clock() - start);
+    start = clock();
+    for (int i = 0; i < num_points; i++)roots_findroots[i] = T_VLH_FindRoots(P[i]);
+    STATUS_time("Jenkins-Traub root finding of T_VLH done", clock() - start);
+    // the polynomial is ill-conditioned, the roots of Jenkins-Traub are off by up to several deg.C close to Pmax, so the roots are checked against bisection
+    double max_diff_findroots = 0;
+    for (int i = 0; i < num_points; i++)
+    {
+        bool isSame = roots_newton[i].size() == roots_findroots[i].size();
+        for (size_t j = 0; isSame && j < roots_newton[i].size(); j++)
+        {
+            double T_bisection = j == 0 ? T_VLH_Bisection(eos, P[i], H2ONaCl::TMIN_C, T_Pmax) : T_VLH_Bisection(eos, P[i], T_Pmax, H2ONaCl::TMAX_C);
+            isSame = fabs(roots_newton[i][j] - T_bisection) < 1E-8;
+            max_diff_findroots = max(max_diff_findroots, fabs(roots_findroots[i][j] - T_bisection));
+        }
+        if(!isSame)
+        {
+            cout<<"T_VLH is wrong at P="<<P[i]<<" bar:";
+            for (size_t j = 0; j < roots_newton[i].size(); j++)cout<<" "<<roots_newton[i][j];
+            cout<<" vs";
+            for (size_t j = 0; j < roots_findroots[i].size(); j++)cout<<" "<<roots_findroots[i][j];
+            cout<<endl;
+            num_fail++;
+        }
+    }
+    STATUS("Maximum error of Jenkins-Traub root finding: "+to_string(max_diff_findroots)+" deg.C");
+    if(num_fail==0)STATUS("Newton iteration of T_VLH agrees with bisection.");
+    return num_fail;
+}
+int check_fast_region(int num_points)
+{
+    int num_fail = 0;
+    H2ONaCl::cH2ONaCl eos;
+    vector<double> T(num_points), P(num_points), X(num_points);
+    for (int i = 0; i < num_points; i++)
+    {
+        T[i] = (rand()/(double)RAND_MAX)*(H2ONaCl::TMAX_C - H2ONaCl::TMIN_C) + H2ONaCl::TMIN_C; //deg.C
+        P[i] = exp((rand()/(double)RAND_MAX)*log(H2ONaCl::PMAX)); //bar, [1, PMAX]
+        // half of the points have a low salinity, close to the vapor side of V+L and V+H
+        X[i] = i%2 == 0 ? rand()/(double)RAND_MAX : pow(10, -12*(rand()/(double)RAND_MAX)); //wt
+    }
+    clock_t start = clock();
+    eos.findPhaseRegion_fast(T[0], P[0], X[0]);
+    STATUS_time("Tables of the accelerated phase region classifier done", clock() - start);
+    int num_exact = 0;
+    double rate = eos.agreement_findPhaseRegion_fast(num_points, T.data(), P.data(), X.data(), num_exact);
+    STATUS("Agreement of the accelerated phase region classifier: "+to_string(rate*100)+" %, "+to_string(num_exact*100.0/num_points)+" % of the points are classified by the exact path");
+    vector<H2ONaCl::PhaseRegion> region_exact(num_points), region_fast(num_points);
+    start = clock();
+    for (int i = 0; i < num_points; i++)region_exact[i] = eos.findPhaseRegion(T[i], P[i], X[i]);
+    STATUS_time("Exact phase region classifier done", clock() - start);
+    eos.set_fast_region(true);
+    start = clock();
+    for (int i = 0; i < num_points; i++)region_fast[i] = eos.findPhaseRegion(T[i], P[i], X[i]);
+    STATUS_time("Accelerated phase region classifier done", clock() - start);
+    for (int i = 0; i < num_points; i++)
+    {
+        if(region_fast[i] != region_exact[i])
+        {
+            cout<<"Phase region is different at T="<<T[i]<<" C, P="<<P[i]<<" bar, X="<<X[i]<<": "<<region_fast[i]<<", "<<region_exact[i]<<endl;
+            num_fail++;
+        }
+    }
+    if(rate != 1 && num_fail == 0)num_fail++;
+    // prop_pTX uses the salinities of the phases from the interpolated boundaries if m_fast_region is set
+    H2ONaCl::cH2ONaCl eos_exact;
+    double max_diff_rho = 0, max_diff_h = 0;
+    for (int i = 0; i < num_points; i += 10)
+    {
+        H2ONaCl::PROP_H2ONaCl prop_fast = eos.prop_pTX(P[i]*1E5, T[i] + 273.15, X[i]);
+        H2ONaCl::PROP_H2ONaCl prop_exact = eos_exact.prop_pTX(P[i]*1E5, T[i] + 273.15, X[i]);
+        if(isnan(prop_exact.Rho) || isnan(prop_exact.H))continue;
+        max_diff_rho = max(max_diff_rho, fabs(prop_fast.Rho - prop_exact.Rho)/fabs(prop_exact.Rho));
+        max_diff_h = max(max_diff_h, fabs(prop_fast.H - prop_exact.H)/fabs(prop_exact.H));
+        if(prop_fast.Region != prop_exact.Region || !(fabs(prop_fast.Rho - prop_exact.Rho) <= 1E-7*fabs(prop_exact.Rho)) || !(fabs(prop_fast.H - prop_exact.H) <= 1E-7*fabs(prop_exact.H)))
+        {
+            cout<<"prop_pTX is different at T="<<T[i]<<" C, P="<<P[i]<<" bar, X="<<X[i]<<": rho "<<prop_fast.Rho<<", "<<prop_exact.Rho<<", h "<<prop_fast.H<<", "<<prop_exact.H<<endl;
+            num_fail++;
+        }
+    }
+    cout<<"Maximum relative difference of prop_pTX with the accelerated classifier: rho "<<max_diff_rho<<", h "<<max_diff_h<<endl;
+    if(num_fail==0)STATUS("The accelerated phase region classifier agrees with the exact one.");
+    return num_fail;
+}
+int check_prop_columns(int num_points)
+{
+    int num_fail = 0;
+    H2ONaCl::cH2ONaCl eos;
+    vector<double> p(num_points), T(num_points), X(num_points);
+    for (int i = 0; i < num_points; i++)
+    {
+        p[i] = ((rand()/(double)RAND_MAX)*(H2ONaCl::PMAX - H2ONaCl::PMIN) + H2ONaCl::PMIN)*1E5; //Pa
+        T[i] = (rand()/(double)RAND_MAX)*(H2ONaCl::TMAX_C - H2ONaCl::TMIN_C) + H2ONaCl::TMIN_C + 273.15; //K
+        X[i] = rand()/(double)RAND_MAX; //wt
+    }
+    auto isSameValue = [](double a, double b){return a == b || (isnan(a) && isnan(b));};
+    vector<vector<double> > columns(H2ONaCl::NUM_PROP_COLUMNS, vector<double>(num_points));
+    vector<double*> pColumns(H2ONaCl::NUM_PROP_COLUMNS);
+    vector<H2ONaCl::PhaseRegion> region(num_points);
+    for (int EOS_ENERGY = LOOKUPTABLE_FOREST::EOS_ENERGY_T; EOS_ENERGY <= LOOKUPTABLE_FOREST::EOS_ENERGY_H; EOS_ENERGY++)
+    {
+        bool isT = EOS_ENERGY == LOOKUPTABLE_FOREST::EOS_ENERGY_T;
+        // the enthalpy of the pTX points is the input of pHX, the viscosity columns of pHX are not written
+        for (int j = 0; j < H2ONaCl::NUM_PROP_COLUMNS; j++)pColumns[j] = (!isT && (j == H2ONaCl::Column_Mu_l || j == H2ONaCl::Column_Mu_v)) ? NULL : columns[j].data();
+        vector<double> TorH = isT ? T : columns[H2ONaCl::Column_H];
+        clock_t start = clock();
+        eos.prop_columns(num_points, p.data(), TorH.data(), X.data(), (LOOKUPTABLE_FOREST::EOS_ENERGY)EOS_ENERGY, pColumns.data(), region.data());
+        STATUS_time(string("Property columns of ")+(isT ? "pTX" : "pHX")+" done", clock() - start);
+        for (int i = 0; i < num_points; i++)
+        {
+            H2ONaCl::PROP_H2ONaCl prop = isT ? eos.prop_pTX(p[i], TorH[i], X[i]) : eos.prop_pHX(p[i], TorH[i], X[i]);
+            double values[H2ONaCl::NUM_PROP_COLUMNS] = {prop.T, prop.P, prop.X_wt, prop.H, prop.Cp, prop.Rho, prop.Mu, prop.Rho_l, prop.Rho_v, prop.Rho_h, prop.H_l, prop.H_v, prop.H_h, 
+                                                        prop.Cp_l, prop.Cp_v, prop.Cp_h, prop.S_l, prop.S_v, prop.S_h, prop.X_l, prop.X_v, prop.Mu_l, prop.Mu_v, prop.dRhodH};
+            bool isSame = region[i] == prop.Region;
+            for (int j = 0; j < H2ONaCl::NUM_PROP_COLUMNS; j++)
+            {
+                if(pColumns[j] && !isSameValue(columns[j][i], values[j]))
+                {
+                    cout<<eos.getPropColumnName(j)<<" is different: "<<columns[j][i]<<", "<<values[j]<<endl;
+                    isSame = false;
+                }
+            }
+            if(!isSame)
+            {
+                cout<<"Property columns are different at p="<<p[i]<<" Pa, "<<(isT ? "T=" : "H=")<<TorH[i]<<", X="<<X[i]<<endl;
+                num_fail++;
+            }
+        }
+    }
+    if(num_fail==0)STATUS("Property columns are the same as prop_pTX and prop_pHX.");
+    return num_fail;
+}
+int check_Phi_r()
+{
+    int num_fail = 0;
+    H2O::cH2O water;
+    // Table 6 of the IAPWS-95 release: T = 500 K, rho = 838.025 kg/m3
+    const double delta = 838.025/H2O::Rho_Critic, tau = H2O::T_Critic_K/500.0;
+    const double values[6] = {-0.342693206E1, -0.364366650, 0.856063701, -0.581403435E1, -0.223440737E1, -0.112176915E1};
+    const char* names[6] = {"phi_r", "phi_r_delta", "phi_r_deltadelta", "phi_r_tau", "phi_r_tautau", "phi_r_deltatau"};
+    H2O::Phi_r_STRUCT phi_r;
+    water.Phi_r_all(delta, tau, phi_r);
+    double fused[6] = {phi_r.phi, phi_r.phi_delta, phi_r.phi_deltadelta, phi_r.phi_tau, phi_r.phi_tautau, phi_r.phi_deltatau};
+    double single[6] = {water.Phi_r(delta, tau), water.Phi_r_delta(delta, tau), water.Phi_r_deltadelta(delta, tau), water.Phi_r_tau(delta, tau), water.Phi_r_tautau(delta, tau), water.Phi_r_deltatau(delta, tau)};
+    for (int i = 0; i < 6; i++)
+    {
+        if(!(fabs(fused[i] - values[i]) < 1E-8*fabs(values[i])) || fused[i] != single[i])
+        {
+            cout<<names[i]<<" is different: "<<fused[i]<<", "<<single[i]<<", reference "<<values[i]<<endl;
+            num_fail++;
+        }
+    }
+    if(num_fail==0)STATUS("Residual Helmholtz free energy and its derivatives agree with the IAPWS-95 verification values.");
+    return num_fail;
+}
+int check_prop_pHX(int num_points)
+{
+    int num_fail = 0, num_valid = 0;
+    H2ONaCl::cH2ONaCl eos;
+    double num_eval = 0, num_eval_warm = 0;
+    for (int i = 0; i < num_points; i++)
+    {
+        double T_C = (rand()/(double)RAND_MAX)*(1000 - 1) + 1;
+        double p_Pa = (rand()/(double)RAND_MAX)*(2000E5 - 5E5) + 5E5;
+        double X_wt = (i%5 == 0 ? 0 : (rand()/(double)RAND_MAX));
+        double H = eos.prop_pTX(p_Pa, T_C + Kelvin, X_wt, false).H;
+        if(std::isnan(H))continue;
+        num_valid++;
+        H2ONaCl::PHX_SOLVE_INFO info, info_warm;
+        H2ONaCl::PROP_H2ONaCl prop = eos.prop_pHX(p_Pa, H, X_wt, NAN, &info);
+        H2ONaCl::PROP_H2ONaCl prop_warm = eos.prop_pHX(p_Pa, H, X_wt, T_C + 1, &info_warm);
+        num_eval += info.num_eval;
+        num_eval_warm += info_warm.num_eval;
+        if(!info.converged || !info_warm.converged || !(fabs(prop.H - H) <= 1E-4*fabs(H)) || !(fabs(prop_warm.H - H) <= 1E-4*fabs(H)))
+        {
+            cout<<"prop_pHX doesn't converge at T="<<T_C<<" C, p="<<p_Pa<<" Pa, X="<<X_wt<<", H="<<H<<": "<<prop.H<<", "<<prop_warm.H<<endl;
+            num_fail++;
+        }
+    }
+    cout<<"Average number of prop_pTX evaluations: "<<num_eval/num_valid<<", with initial guess: "<<num_eval_warm/num_valid<<endl;
+    // an enthalpy out of the temperature range has no solution, all the properties must be NAN instead of a 0 deg.C state
+    H2ONaCl::PHX_SOLVE_INFO info;
+    H2ONaCl::PROP_H2ONaCl prop = eos.prop_pHX(100E5, 1E8, 0.1, NAN, &info);
+    if(info.converged || prop.Region != H2ONaCl::UnknownPhaseRegion || !std::isnan(prop.T) || !std::isnan(prop.Rho) || !std::isnan(prop.Mu_v) || !std::isnan(prop.Cp) || !std::isnan(prop.dRhodH))
+    {
+        cout<<"prop_pHX out of range is not unknown: T="<<prop.T<<" C, region "<<prop.Region<<endl;
+        num_fail++;
+    }
+    if(num_fail==0)STATUS("prop_pHX converges at all valid points.");
+    return num_fail;
+}
+int check_prop_pHX_hint(int num_points)
+{
+    int num_fail = 0;
+    H2ONaCl::cH2ONaCl eos;
+    vector<double> p_Pa(num_points), H(num_points), X_wt(num_points);
+    vector<H2ONaCl::PHX_HINT> hints(num_points);
+    vector<H2ONaCl::PROP_H2ONaCl> props(num_points);
+    vector<H2ONaCl::PHX_SOLVE_INFO> info(num_points);
+    for (int i = 0; i < num_points; i++)
+    {
+        double T_C = (rand()/(double)RAND_MAX)*(1000 - 1) + 1;
+        p_Pa[i] = (rand()/(double)RAND_MAX)*(2000E5 - 5E5) + 5E5;
+        X_wt[i] = (i%5 == 0 ? 0 : (rand()/(double)RAND_MAX));
+        H[i] = eos.prop_pTX(p_Pa[i], T_C + Kelvin, X_wt[i], false).H;
+        if(std::isnan(H[i]))
+        {
+            H[i] = 1E6; X_wt[i] = 0.1;
+        }
+        hints[i].T = NAN;
+        hints[i].dHdT = NAN;
+        hints[i].Region = H2ONaCl::UnknownPhaseRegion;
+    }
+    // time steps with small changes of enthalpy
+    double num_eval_first = 0, num_eval_hint = 0;
+    const int num_steps = 4;
+    for (int step = 0; step < num_steps; step++)
+    {
+        eos.prop_pHX_batch(num_points, p_Pa.data(), H.data(), X_wt.data(), hints.data(), props.data(), info.data());
+        for (int i = 0; i < num_points; i++)
+        {
+            if(step == 0)num_eval_first += info[i].num_eval;
+            else num_eval_hint += info[i].num_eval;
+            if(std::isnan(props[i].H))continue; // out of the valid range
+            if(!info[i].converged || !(fabs(props[i].H - H[i]) <= 1E-4*fabs(H[i])) || props[i].T != hints[i].T)
+            {
+                cout<<"prop_pHX with hint doesn't converge at step "<<step<<", p="<<p_Pa[i]<<" Pa, X="<<X_wt[i]<<", H="<<H[i]<<": "<<props[i].H<<endl;
+                num_fail++;
+            }
+        }
+        for (int i = 0; i < num_points; i++)H[i] *= 1 + 1E-3*(2*rand()/(double)RAND_MAX - 1);
+    }
+    num_eval_first /= num_points;
+    num_eval_hint /= (num_points*(num_steps - 1));
+    cout<<"Average number of prop_pTX evaluations: "<<num_eval_first<<", with hints: "<<num_eval_hint<<endl;
+    if(!(num_eval_hint < num_eval_first))num_fail++;
+    if(num_fail==0)STATUS("prop_pHX with hints converges at all valid points.");
+    return num_fail;
+}
+template <typename LUT>
+int compare_lut_props(LUT* pLUT_a, LUT* pLUT_b)
+{
+    int num_fail = 0;
+    if(pLUT_a->m_props_unique_points_leaves.num_points != pLUT_b->m_props_unique_points_leaves.num_points)
+    {
+        cout<<"Number of unique points is different: "<<pLUT_a->m_props_unique_points_leaves.num_points<<" vs "<<pLUT_b->m_props_unique_points_leaves.num_points<<endl;
+        return 1;
+    }
+    int num_props = pLUT_a->m_props_unique_points_leaves.num_props;
+    for (LOOKUPTABLE_FOREST::int_pointIndex i = 0; i < pLUT_a->m_props_unique_points_leaves.num_points; i++)
+    {
+        // nan is a valid property value, e.g. in the H-P space out of the range of the EOS
+        for (int j = 0; j < num_props; j++)
+        {
+            if(memcmp(&pLUT_a->m_props_unique_points_leaves.at(i, j), &pLUT_b->m_props_unique_points_leaves.at(i, j), sizeof(double)) != 0)
+            {
+                cout<<"Properties of point "<<i<<" are different"<<endl;
+                num_fail++;
+                break;
+            }
+        }
+    }
+    return num_fail;
+}
+int compare_vertex_cache(int max_level)
+{
+    int num_fail = 0;
+    double TP_min[2] = {1 + 273.15, 5E5}; //T [K], P[Pa]
+    double TP_max[2] = {700 + 273.15, 400E5};
+    double HP_min[2] = {0.1E6, 5E5}; //H [J/kg], P[Pa]
+    double HP_max[2] = {3.5E6, 400E5};
+    double X_wt = 0.2;
+    int min_level = 4;
+    int update_props = Update_prop_rho | Update_prop_h | Update_prop_T;
+    for (int TorH = 0; TorH < 2; TorH++)
+    {
+        H2ONaCl::cH2ONaCl eos_cache, eos_nocache;
+        eos_nocache.set_lut_vertex_cache(false);
+        if(TorH == 0)
+        {
+            eos_cache.createLUT_2D(TP_min, TP_max, X_wt, LOOKUPTABLE_FOREST::CONST_X_VAR_TorHP, LOOKUPTABLE_FOREST::EOS_ENERGY_T, min_level, max_level, update_props);
+            eos_nocache.createLUT_2D(TP_min, TP_max, X_wt, LOOKUPTABLE_FOREST::CONST_X_VAR_TorHP, LOOKUPTABLE_FOREST::EOS_ENERGY_T, min_level, max_level, update_props);
+        }else
+        {
+            eos_cache.createLUT_2D(HP_min, HP_max, X_wt, LOOKUPTABLE_FOREST::CONST_X_VAR_TorHP, LOOKUPTABLE_FOREST::EOS_ENERGY_H, min_level, max_level, update_props);
+            eos_nocache.createLUT_2D(HP_min, HP_max, X_wt, LOOKUPTABLE_FOREST::CONST_X_VAR_TorHP, LOOKUPTABLE_FOREST::EOS_ENERGY_H, min_level, max_level, update_props);
+        }
+        H2ONaCl::LookUpTableForest_2D* pLUT_cache = eos_cache.getLUT_2D();
+        H2ONaCl::LookUpTableForest_2D* pLUT_nocache = eos_nocache.getLUT_2D();
+        if(pLUT_cache->m_vertex_cache.num_hit() == 0 || pLUT_nocache->m_vertex_cache.num_hit() + pLUT_nocache->m_vertex_cache.num_miss() != 0)
+        {
+            cout<<"The vertex cache is not used as expected"<<endl;
+            num_fail++;
+        }
+        num_fail += compare_lut_props(pLUT_cache, pLUT_nocache);
+    }
+    if(num_fail==0)STATUS("LUT built with and without vertex cache are the same.");
+    return num_fail;
+}
+int compare_refine_level(int max_level)
+{
+    int num_fail = 0;
+    double HPX_min[3] = {0.1E6, 5E5, 0.001}; //H [J/kg], P[Pa], X [wt]
+    double HPX_max[3] = {3.5E6, 400E5, 0.4};
+    int min_level = 2;
+    int update_props = Update_prop_rho | Update_prop_h | Update_prop_T;
+    H2ONaCl::cH2ONaCl eos_recursive, eos_level, eos_linear;
+    eos_recursive.set_lut_refine_level(false);
+    eos_recursive.createLUT_3D(HPX_min, HPX_max, LOOKUPTABLE_FOREST::EOS_ENERGY_H, min_level, max_level, update_props);
+    eos_level.set_lut_refine_level(true);
+    eos_level.createLUT_3D(HPX_min, HPX_max, LOOKUPTABLE_FOREST::EOS_ENERGY_H, min_level, max_level, update_props);
+    eos_linear.set_lut_refine_level(true);
+    eos_linear.set_lut_storage(LOOKUPTABLE_FOREST::LUT_STORAGE_LINEAR);
+    eos_linear.createLUT_3D(HPX_min, HPX_max, LOOKUPTABLE_FOREST::EOS_ENERGY_H, min_level, max_level, update_props);
+    num_fail += compare_lut_props(eos_recursive.getLUT_3D(), eos_level.getLUT_3D());
+    num_fail += compare_lut_props(eos_recursive.getLUT_3D(), eos_linear.getLUT_3D());
+    if(num_fail==0)STATUS("Breadth-first and recursive refinement give the same LUT.");
+    return num_fail;
+}
+int compare_props_layout(int max_level)
+{
+    int num_fail = 0;
+    double TPX_min[3] = {1 + 273.15, 5E5, 0.001}; //T [K], P[Pa], X [wt]
+    double TPX_max[3] = {700 + 273.15, 400E5, 0.4};
+    int min_level = 3;
+    int update_props = Update_prop_rho | Update_prop_h;
+    string filename = "lut_layout_"+std::to_string(max_level)+".bin";
+    H2ONaCl::cH2ONaCl eos_aos, eos_soa;
+    eos_aos.createLUT_3D(TPX_min, TPX_max, LOOKUPTABLE_FOREST::EOS_ENERGY_T, min_level, max_level, update_props);
+    eos_soa.set_lut_props_layout(LOOKUPTABLE_FOREST::PROPS_LAYOUT_SOA);
+    eos_soa.createLUT_3D(TPX_min, TPX_max, LOOKUPTABLE_FOREST::EOS_ENERGY_T, min_level, max_level, update_props);
+    num_fail += compare_lut_props(eos_aos.getLUT_3D(), eos_soa.getLUT_3D());
+    // both file formats written from the property-major layout are loaded to the other layout
+    eos_soa.save_lut_to_binary(filename);
+    eos_soa.save_lut_to_single_binary("single_"+filename);
+    H2ONaCl::cH2ONaCl eos_load, eos_load_single;
+    eos_load.loadLUT(filename);
+    eos_load_single.set_lut_props_layout(LOOKUPTABLE_FOREST::PROPS_LAYOUT_SOA);
+    eos_load_single.set_lut_storage(LOOKUPTABLE_FOREST::LUT_STORAGE_LINEAR);
+    eos_load_single.loadLUT("single_"+filename);
+    if(eos_load.getLUT_3D()->m_props_unique_points_leaves.layout != LOOKUPTABLE_FOREST::PROPS_LAYOUT_AOS || eos_load_single.getLUT_3D()->m_props_unique_points_leaves.layout != LOOKUPTABLE_FOREST::PROPS_LAYOUT_SOA)
+    {
+        cout<<"Layout of the loaded LUT is not the required one"<<endl;
+        num_fail++;
+    }
+    num_fail += compare_lut_props(eos_aos.getLUT_3D(), eos_load.getLUT_3D());
+    num_fail += compare_lut_props(eos_aos.getLUT_3D(), eos_load_single.getLUT_3D());
+    // lookup
+    const int num_eos = 4;
+    H2ONaCl::cH2ONaCl* eos[num_eos] = {&eos_aos, &eos_soa, &eos_load, &eos_load_single};
+    int num_props = eos_aos.getLUT_3D()->m_map_props.size();
+    int n_randSample = 1E4;
+    vector<double> T_K(n_randSample), p_Pa(n_randSample), X_wt(n_randSample);
+    for (int i = 0; i < n_randSample; i++)
+    {
+        T_K[i] = (rand()/(double)RAND_MAX)*(TPX_max[0] - TPX_min[0]) + TPX_min[0];
+        p_Pa[i] = (rand()/(double)RAND_MAX)*(TPX_max[1] - TPX_min[1]) + TPX_min[1];
+        X_wt[i] = (rand()/(double)RAND_MAX)*(TPX_max[2] - TPX_min[2]) + TPX_min[2];
+    }
+    vector<vector<double> > props_batch(num_eos*num_props, vector<double>(n_randSample));
+    vector<double*> pProps(num_eos*num_props);
+    for (int j = 0; j < num_eos*num_props; j++)pProps[j] = props_batch[j].data();
+    for (int k = 0; k < num_eos; k++)
+    {
+        clock_t start = clock();
+        eos[k]->lookup_batch(n_randSample, T_K.data(), p_Pa.data(), X_wt.data(), &pProps[k*num_props]);
+        STATUS_time("Batch lookup of "+string(eos[k]->getLUT_3D()->m_props_unique_points_leaves.layout == LOOKUPTABLE_FOREST::PROPS_LAYOUT_AOS ? "point" : "property")+"-major layout done", clock() - start);
+    }
+    double* props = new double[num_props];
+    double xyz_min_target[3];
+    for (int i = 0; i < n_randSample; i++)
+    {
+        eos_soa.lookup(props, xyz_min_target, T_K[i], p_Pa[i], X_wt[i], false);
+        bool isSame = true;
+        for (int j = 0; j < num_props; j++)
+        {
+            isSame = isSame && (props[j] == props_batch[j][i]);
+            for (int k = 1; k < num_eos; k++)isSame = isSame && (props_batch[j][i] == props_batch[k*num_props + j][i]);
+        }
+        if(!isSame)
+        {
+            cout<<"Lookup result is different at T="<<T_K[i]<<" K, p="<<p_Pa[i]<<" Pa, X="<<X_wt[i]<<endl;
+            num_fail++;
+        }
+    }
+    delete[] props;
+    if(num_fail==0)STATUS("Point-major and property-major layouts give the same result.");
+    return num_fail;
+}
+template <int dim>
+int check_interp_kernel(int num_points)
+{
+    int num_fail = 0;
+    const int num_nodes = 1<<dim;
+    const int max_props = 9; //covers the AVX-512 and AVX2 loops and the scalar remainder
+    double xyz_min[3] = {-1, 2, 0.5}, length[3] = {0.5, 3, 0.25};
+    // vertex values in both layouts, SoA stride is num_nodes
+    double values_aos[num_nodes][max_props], values_soa[max_props][num_nodes];
+    const double* nodes_aos[num_nodes];
+    const double* nodes_soa[num_nodes];
+    for (int i = 0; i < num_nodes; i++)
+    {
+        for (int j = 0; j < max_props; j++)values_aos[i][j] = values_soa[j][i] = (rand()/(double)RAND_MAX - 0.5)*pow(10, j);
+        nodes_aos[i] = values_aos[i];
+        nodes_soa[i] = &values_soa[0][i];
+    }
+    vector<vector<double> > xyz(dim, vector<double>(num_points));
+    const double* pXYZ[dim];
+    for (int d = 0; d < dim; d++)
+    {
+        for (int i = 0; i < num_points; i++)xyz[d][i] = xyz_min[d] + rand()/(double)RAND_MAX*length[d];
+        pXYZ[d] = xyz[d].data();
+    }
+    vector<vector<double> > props_batch(max_props, vector<double>(num_points));
+    vector<double*> pProps(max_props);
+    for (int j = 0; j < max_props; j++)pProps[j] = props_batch[j].data();
+    for (int num_props = 1; num_props <= max_props; num_props++)
+    {
+        for (int layout = 0; layout < 2; layout++)
+        {
+            const double* const* nodes = layout==0 ? nodes_aos : nodes_soa;
+            size_t stride_prop = layout==0 ? 1 : num_nodes;
+            bilinear_cal_props_batch<dim>(xyz_min, length, nodes, stride_prop, num_props, pXYZ, 0, num_points, pProps.data());
+            for (int i = 0; i < num_points; i++)
+            {
+                double xyz_point[dim], coeff[dim][2], props[max_props], values_at_vertices[1<<dim], result;
+                for (int d = 0; d < dim; d++)xyz_point[d] = xyz[d][i];
+                get_coeff_bilinear<dim>(xyz_min, length, xyz_point, coeff);
+                bilinear_cal_props<dim>(coeff, nodes, stride_prop, num_props, props);
+                for (int j = 0; j < num_props; j++)
+                {
+                    for (int k = 0; k < num_nodes; k++)values_at_vertices[k] = values_soa[j][k];
+                    bilinear_cal<dim>(coeff, values_at_vertices, result);
+                    if(fabs(props[j] - result) > 1E-12*pow(10, j) || props[j] != props_batch[j][i])
+                    {
+                        cout<<"Interpolation of property "<<j<<" of "<<num_props<<" is different at point "<<i<<": "<<props[j]<<", "<<props_batch[j][i]<<", "<<result<<endl;
+                        num_fail++;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    if(num_fail==0)STATUS("Multi-property interpolation of "+to_string(dim)+"D agrees with bilinear_cal.");
+    return num_fail;
+}
+// ------ read back the .vtu files of write_to_vtk/write_to_vtu, only the encodings written by the forest are supported ------
+string read_file(string filename)
+{
+    std::ifstream fin(filename, std::ios::binary);
+    return string((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+}
+string xml_attribute(const string& tag, string name)
+{
+    size_t pos = tag.find(" "+name+"=\"");
+    if(pos == string::npos)return "";
+    pos += name.size() + 3;
+    return tag.substr(pos, tag.find('"', pos) - pos);
+}
+void decode_base64(const char* text, size_t num_chars, vector<unsigned char>& out)
+{
+    out.clear();
+    unsigned int buffer = 0;
+    int num_bits = 0;
+    for (size_t i = 0; i < num_chars && text[i] != '='; i++)
+    {
+        const char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        buffer = (buffer<<6) | (unsigned int)(strchr(table, text[i]) - table);
+        num_bits += 6;
+        if(num_bits >= 8)
+        {
+            num_bits -= 8;
+            out.push_back((buffer>>num_bits) & 0xFF);
+        }
+    }
+}
+/**
+ * @brief Minimal inflate of the stored and fixed-Huffman blocks of a zlib stream, including the Adler-32 check. 
+ * 
+ * @return false if the stream uses dynamic Huffman blocks or is corrupt
+ */
+bool inflate_zlib(const unsigned char* data, size_t size, vector<unsigned char>& out)
+{
+    static const int length_base[29] = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258};
+    static const int length_extra[29] = {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0};
+    static const int dist_base[30] = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577};
+    static const int dist_extra[30] = {0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
+    out.clear();
+    if(size < 6 || ((data[0]<<8) | data[1]) % 31 != 0 || (data[0] & 0x0F) != 8)return false;
+    size_t pos_bit = 16, size_bits = (size - 4)*8;
+    auto bit = [&]() -> unsigned int { unsigned int b = (data[pos_bit>>3]>>(pos_bit & 7)) & 1; pos_bit++; return b; };
+    auto bits = [&](int n) -> unsigned int { unsigned int v = 0; for (int i = 0; i < n; i++)v |= bit()<<i; return v; };
+    auto code = [&](int n) -> unsigned int { unsigned int v = 0; for (int i = 0; i < n; i++)v = (v<<1) | bit(); return v; };
+    bool isFinal = false;
+    while (!isFinal)
+    {
+        if(pos_bit + 3 > size_bits)return false;
+        isFinal = bit();
+        unsigned int type = bits(2);
+        if(type == 0)
+        {
+            pos_bit = (pos_bit + 7) & ~(size_t)7;
+            if(pos_bit + 32 > size_bits)return false;
+            size_t len = data[pos_bit/8] | (data[pos_bit/8 + 1]<<8), nlen = data[pos_bit/8 + 2] | (data[pos_bit/8 + 3]<<8);
+            pos_bit += 32;
+            if((len ^ 0xFFFF) != nlen || pos_bit + len*8 > size_bits)return false;
+            out.insert(out.end(), data + pos_bit/8, data + pos_bit/8 + len);
+            pos_bit += len*8;
+        }else if(type == 1)
+        {
+            while (true)
+            {
+                if(pos_bit + 7 > size_bits)return false;
+                unsigned int symbol = code(7);
+                if(symbol <= 0x17)symbol += 256;
+                else
+                {
+                    symbol = (symbol<<1) | bit();
+                    if(symbol >= 0x30 && symbol <= 0xBF)symbol -= 0x30;
+                    else if(symbol >= 0xC0 && symbol <= 0xC7)symbol += 280 - 0xC0;
+                    else symbol = ((symbol<<1) | bit()) - 0x190 + 144;
+                }
+                if(symbol < 256)out.push_back(symbol);
+                else if(symbol == 256)break;
+                else
+                {
+                    if(symbol > 285)return false;
+                    size_t length = length_base[symbol - 257] + bits(length_extra[symbol - 257]);
+                    unsigned int symbol_dist = code(5);
+                    if(symbol_dist > 29)return false;
+                    size_t dist = dist_base[symbol_dist] + bits(dist_extra[symbol_dist]);
+                    if(dist > out.size())return false;
+                    for (size_t i = 0; i < length; i++)out.push_back(out[out.size() - dist]);
+                }
+            }
+        }else
+        {
+            return false;
+        }
+    }
+    unsigned int a = 1, b = 0;
+    for (size_t i = 0; i < out.size(); i++){ a = (a + out[i]) % 65521; b = (b + a) % 65521;}
+    const unsigned char* adler = data + size - 4;
+    return ((b<<16) | a) == (((unsigned int)adler[0]<<24) | (adler[1]<<16) | (adler[2]<<8) | adler[3]);
+}
+/**
+ * @brief Read all DataArrays of a .vtu file, the values are converted to double.
+ * 
+ * @return Number of arrays which can not be decoded
+ */
+int read_vtu_arrays(string filename, std::map<string, vector<double> >& arrays, size_t& num_cells)
+{
+    int num_fail = 0;
+    string content = read_file(filename);
+    size_t pos_appended = content.find("<AppendedData");
+    string xml = content.substr(0, pos_appended);
+    bool isCompressed = xml.find("compressor=\"vtkZLibDataCompressor\"") != string::npos;
+    bool isBase64 = pos_appended != string::npos && xml_attribute(content.substr(pos_appended, content.find('>', pos_appended) - pos_appended), "encoding") == "base64";
+    const char* appended = pos_appended == string::npos ? NULL : content.data() + content.find('_', pos_appended) + 1;
+    size_t pos_piece = xml.find("<Piece");
+    num_cells = pos_piece == string::npos ? 0 : atol(xml_attribute(xml.substr(pos_piece, xml.find('>', pos_piece) - pos_piece), "NumberOfCells").c_str());
+    arrays.clear();
+    for (size_t pos = xml.find("<DataArray"); pos != string::npos; pos = xml.find("<DataArray", pos + 1))
+    {
+        size_t pos_end = xml.find('>', pos);
+        string tag = xml.substr(pos, pos_end - pos), type = xml_attribute(tag, "type");
+        vector<double>& values = arrays[xml_attribute(tag, "Name")];
+        if(xml_attribute(tag, "format") == "ascii")
+        {
+            const char* p = xml.c_str() + pos_end + 1;
+            const char* p_end = xml.c_str() + xml.find("</DataArray>", pos_end);
+            char* p_next = NULL;
+            for (double v = strtod(p, &p_next); p_next != p && p_next <= p_end; v = strtod(p, &p_next))
+            {
+                values.push_back(v);
+                p = p_next;
+            }
+            continue;
+        }
+        const char* p = appended + atol(xml_attribute(tag, "offset").c_str());
+        vector<unsigned char> bytes, block;
+        unsigned long long size_header[3];
+        if(isCompressed)
+        {
+            // header: number of blocks, block size, size of the last block, compressed size of each block
+            vector<unsigned char> header;
+            if(isBase64)decode_base64(p, VTU::Base64Stream::encoded_size(3*8), header);
+            else header.assign(p, p + 3*8);
+            memcpy(size_header, header.data(), 3*8);
+            size_t size_header_bytes = (3 + size_header[0])*8;
+            if(isBase64)
+            {
+                decode_base64(p, VTU::Base64Stream::encoded_size(size_header_bytes), header);
+                p += VTU::Base64Stream::encoded_size(size_header_bytes);
+            }else
+            {
+                header.assign(p, p + size_header_bytes);
+                p += size_header_bytes;
+            }
+            vector<unsigned long long> size_blocks(size_header[0] + 3);
+            memcpy(size_blocks.data(), header.data(), size_header_bytes);
+            size_t size_compressed = 0;
+            for (size_t i = 0; i < size_header[0]; i++)size_compressed += size_blocks[3 + i];
+            vector<unsigned char> compressed;
+            if(isBase64)decode_base64(p, VTU::Base64Stream::encoded_size(size_compressed), compressed);
+            else compressed.assign(p, p + size_compressed);
+            size_t offset = 0;
+            for (size_t i = 0; i < size_header[0]; i++)
+            {
+                size_t size_block = (i + 1 == size_header[0] && size_header[2] != 0) ? size_header[2] : size_header[1];
+                if(!inflate_zlib(compressed.data() + offset, size_blocks[3 + i], block) || block.size() != size_block)
+                {
+                    cout<<"Can not inflate block "<<i<<" of "<<xml_attribute(tag, "Name")<<" in "<<filename<<endl;
+                    num_fail++;
+                }
+                bytes.insert(bytes.end(), block.begin(), block.end());
+                offset += size_blocks[3 + i];
+            }
+        }else
+        {
+            if(isBase64)
+            {
+                decode_base64(p, VTU::Base64Stream::encoded_size(8), block);
+                memcpy(size_header, block.data(), 8);
+                decode_base64(p, VTU::Base64Stream::encoded_size(8 + size_header[0]), bytes);
+                bytes.erase(bytes.begin(), bytes.begin() + 8);
+            }else
+            {
+                memcpy(size_header, p, 8);
+                bytes.assign(p + 8, p + 8 + size_header[0]);
+            }
+        }
+        if(type == "Float32")
+        {
+            values.resize(bytes.size()/4);
+            for (size_t i = 0; i < values.size(); i++){ float v; memcpy(&v, &bytes[i*4], 4); values[i] = v;}
+        }else if(type == "Int32")
+        {
+            values.resize(bytes.size()/4);
+            for (size_t i = 0; i < values.size(); i++){ int v; memcpy(&v, &bytes[i*4], 4); values[i] = v;}
+        }else
+        {
+            values.assign(bytes.begin(), bytes.end());
+        }
+    }
+    return num_fail;
+}
+/**
+ * @brief Compare the cells [0, num_cells) of a .vtu piece with the cells [cell_begin, cell_begin+num_cells) of the ASCII file of write_to_vtk, 
+ * point values are compared through the connectivity of each file, because the piece only contains its own points.
+ * 
+ */
+int compare_vtu_cells(std::map<string, vector<double> >& ref, std::map<string, vector<double> >& arrays, size_t cell_begin, size_t num_cells, int num_nodes, string filename)
+{
+    for(auto &m : ref)
+    {
+        if(m.first == "connectivity" || m.first == "offsets" || m.first == "types")continue;
+        bool isCellData = m.first == "phaseIndex" || m.first == "needRefine";
+        int num_components = m.first == "Position" ? 3 : 1;
+        vector<double>& values = arrays[m.first];
+        for (size_t i = 0; i < num_cells; i++)
+        {
+            for (int i_node = 0; i_node < (isCellData ? 1 : num_nodes); i_node++)
+            {
+                for (int c = 0; c < num_components; c++)
+                {
+                    size_t ind_ref = isCellData ? cell_begin + i : (size_t)ref["connectivity"][(cell_begin + i)*num_nodes + i_node]*num_components + c;
+                    size_t ind = isCellData ? i : (size_t)arrays["connectivity"][i*num_nodes + i_node]*num_components + c;
+                    // the ASCII file has 6 significant digits
+                    if(ind >= values.size() || fabs(values[ind] - m.second[ind_ref]) > 1E-5*fabs(m.second[ind_ref]))
+                    {
+                        cout<<m.first<<" of cell "<<i<<" in "<<filename<<" is different from the ASCII file"<<endl;
+                        return 1;
+                    }
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < num_cells; i++)
+    {
+        if(arrays["offsets"][i] != (i + 1)*num_nodes || arrays["types"][i] != ref["types"][0])
+        {
+            cout<<"Offset or type of cell "<<i<<" in "<<filename<<" is wrong"<<endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+int check_vtu_writer(int max_level)
+{
+    int num_fail = 0;
+    double TP_min[2] = {1 + 273.15, 5E5}; //T [K], P[Pa]
+    double TP_max[2] = {700 + 273.15, 400E5};
+    double X_wt = 0.2;
+    int min_level = 4;
+    H2ONaCl::cH2ONaCl eos;
+    eos.createLUT_2D(TP_min, TP_max, X_wt, LOOKUPTABLE_FOREST::CONST_X_VAR_TorHP, LOOKUPTABLE_FOREST::EOS_ENERGY_T, min_level, max_level, Update_prop_rho | Update_prop_h | Update_prop_drhodh);
+    H2ONaCl::LookUpTableForest_2D* pLUT = eos.getLUT_2D();
+    const int num_nodes = 4;
+    std::map<string, vector<double> > ref, arrays;
+    size_t num_cells = 0, num_cells_piece = 0;
+    pLUT->write_to_vtk("lut_vtu_legacy.vtu");
+    num_fail += read_vtu_arrays("lut_vtu_legacy.vtu", ref, num_cells);
+    // every format of one file
+    const char* name_format[3] = {"ascii", "raw", "base64"};
+    for (int format = LOOKUPTABLE_FOREST::VTU_FORMAT_ASCII; format <= LOOKUPTABLE_FOREST::VTU_FORMAT_BASE64; format++)
+    {
+        for (int compress = 0; compress < (format == LOOKUPTABLE_FOREST::VTU_FORMAT_ASCII ? 1 : 2); compress++)
+        {
+            string filename = string("lut_vtu_")+name_format[format]+(compress ? "_zlib" : "")+".vtu";
+            clock_t start = clock();
+            eos.save_lut_to_vtu(filename, (LOOKUPTABLE_FOREST::VTU_FORMAT)format, compress);
+            num_fail += read_vtu_arrays(filename, arrays, num_cells_piece);
+            STATUS_time(filename+" is written and read", clock() - start);
+            if(num_cells_piece != num_cells)
+            {
+                cout<<filename<<" has "<<num_cells_piece<<" cells, but the ASCII file has "<<num_cells<<endl;
+                num_fail++;
+                continue;
+            }
+            num_fail += compare_vtu_cells(ref, arrays, 0, num_cells, num_nodes, filename);
+        }
+    }
+    // pieces of the pvtu file, in the order of the cells
+    int num_pieces = 3;
+    eos.save_lut_to_pvtu("lut_vtu.pvtu", num_pieces, LOOKUPTABLE_FOREST::VTU_FORMAT_RAW, true);
+    string pvtu = read_file("lut_vtu.pvtu");
+    size_t cell_begin = 0;
+    int ind = 0;
+    for (size_t pos = pvtu.find("<Piece"); pos != string::npos; pos = pvtu.find("<Piece", pos + 1), ind++)
+    {
+        string filename = xml_attribute(pvtu.substr(pos, pvtu.find('>', pos) - pos), "Source");
+        num_fail += read_vtu_arrays(filename, arrays, num_cells_piece);
+        num_fail += compare_vtu_cells(ref, arrays, cell_begin, num_cells_piece, num_nodes, filename);
+        cell_begin += num_cells_piece;
+    }
+    if(ind != num_pieces || cell_begin != num_cells)
+    {
+        cout<<"The pvtu file has "<<ind<<" pieces with "<<cell_begin<<" cells, expected "<<num_pieces<<" pieces with "<<num_cells<<" cells"<<endl;
+        num_fail++;
+    }
+    if(num_fail==0)STATUS("ASCII, raw and base64 vtu files, with and without compression, and the pvtu pieces agree with the ASCII file.");
+    return num_fail;
+}
+/**
+ * @brief Compare lookup_batch_cal with the single point lookup(double* props, ..., is_cal=true), the LUT of eos is created already.
+ * 
+ */
+int compare_lookup_deferred(H2ONaCl::cH2ONaCl& eos, const double* xyz_min, const double* xyz_max, int num_points, string name)
+{
+    int num_fail = 0;
+    const int dim = eos.m_dim_lut;
+    std::map<int, propInfo>& map_props = dim == 2 ? eos.getLUT_2D()->m_map_props : eos.getLUT_3D()->m_map_props;
+    const int num_props = map_props.size();
+    vector<vector<double> > xyz(3, vector<double>(num_points, 0));
+    for (int i = 0; i < num_points; i++)
+    {
+        for (int d = 0; d < dim; d++)xyz[d][i] = (rand()/(double)RAND_MAX)*(xyz_max[d] - xyz_min[d]) + xyz_min[d];
+    }
+    vector<vector<double> > props_interp(num_props, vector<double>(num_points)), props_batch(num_props, vector<double>(num_points));
+    vector<double*> pProps_interp(num_props), pProps_batch(num_props);
+    for (int j = 0; j < num_props; j++)
+    {
+        pProps_interp[j] = props_interp[j].data();
+        pProps_batch[j] = props_batch[j].data();
+    }
+    const double* z = dim == 3 ? xyz[2].data() : NULL;
+    vector<int> index_deferred;
+    int num_deferred = eos.lookup_batch_deferred(num_points, xyz[0].data(), xyz[1].data(), z, pProps_interp.data(), index_deferred);
+    clock_t start = clock();
+    int num_cal = eos.lookup_batch_cal(num_points, xyz[0].data(), xyz[1].data(), z, pProps_batch.data());
+    STATUS_time(name+": batch lookup with deferred calculation done, "+to_string(num_cal)+"/"+to_string(num_points)+" points calculated by EOS", clock() - start);
+    if(num_cal != num_deferred || num_deferred != (int)index_deferred.size())
+    {
+        cout<<name<<": number of deferred points is different, "<<num_deferred<<", "<<index_deferred.size()<<", "<<num_cal<<endl;
+        num_fail++;
+    }
+    auto isSameValue = [](double a, double b){return a == b || (std::isnan(a) && std::isnan(b));}; //the LUT has nan properties out of the valid region
+    vector<double> props(num_props);
+    double xyz_min_target[3];
+    size_t k = 0;
+    for (int i = 0; i < num_points; i++)
+    {
+        if(dim == 2)eos.lookup(props.data(), xyz_min_target, xyz[0][i], xyz[1][i], true);
+        else eos.lookup(props.data(), xyz_min_target, xyz[0][i], xyz[1][i], xyz[2][i], true);
+        bool isDeferred = (k < index_deferred.size() && index_deferred[k] == i);
+        if(isDeferred)k++;
+        bool isSame = true;
+        for (int j = 0; j < num_props; j++)
+        {
+            isSame = isSame && isSameValue(props[j], props_batch[j][i]);
+            // the points which are not deferred are final after lookup_batch_deferred
+            if(!isDeferred)isSame = isSame && isSameValue(props_interp[j][i], props_batch[j][i]);
+        }
+        if(!isSame)
+        {
+            cout<<name<<": deferred lookup result is different at ("<<xyz[0][i]<<", "<<xyz[1][i]<<", "<<xyz[2][i]<<")"<<endl;
+            num_fail++;
+        }
+    }
+    if(num_fail==0)STATUS(name+": deferred batch lookup and single point lookup give the same result.");
+    return num_fail;
+}
+int check_lookup_deferred(int max_level)
+{
+    int num_fail = 0;
+    int min_level = 3;
+    int num_points = 1E4;
+    H2ONaCl::cH2ONaCl eos_2D;
+    double XH_min[2] = {1E-5, 0.1E6}, XH_max[2] = {0.99999, 3.5E6};
+    eos_2D.createLUT_2D(XH_min, XH_max, 25E6, LOOKUPTABLE_FOREST::CONST_P_VAR_XTorH, LOOKUPTABLE_FOREST::EOS_ENERGY_H, min_level, max_level, Update_prop_rho | Update_prop_h);
+    num_fail += compare_lookup_deferred(eos_2D, XH_min, XH_max, num_points, "2D XH");
+    H2ONaCl::cH2ONaCl eos_3D;
+    double TPX_min[3] = {1 + 273.15, 5E5, 0.001}, TPX_max[3] = {700 + 273.15, 400E5, 0.4};
+    eos_3D.createLUT_3D(TPX_min, TPX_max, LOOKUPTABLE_FOREST::EOS_ENERGY_T, min_level, max_level, Update_prop_rho | Update_prop_h);
+    num_fail += compare_lookup_deferred(eos_3D, TPX_min, TPX_max, num_points, "3D TPX");
+    return num_fail;
+}
 void help(char** argv)
 {
     cout<<"Help information ... "<<endl;
@@ -586,6 +1757,24 @@ void help(char** argv)
     cout<<argv[0]<<" 6 [max_level]: createTable_HPX"<<endl;
     cout<<argv[0]<<" 7 [my.bin] [isFunCal]: load and lookup 2D LUT"<<endl;
     cout<<argv[0]<<" 8 [my.bin] [isFunCal]: load and lookup 3D LUT"<<endl;
+    cout<<argv[0]<<" 9 [max_level]: compare linear and pointer-based LUT storage"<<endl;
+    cout<<argv[0]<<" 10 [max_level]: compare batch and single point lookup of 3D LUT"<<endl;
+    cout<<argv[0]<<" 11 [max_level]: compare single-file LUT loaded by tree, linear and memory-mapped storage"<<endl;
+    cout<<argv[0]<<" 12 [num_points]: compare prop_pTX of one instance shared by all threads and per-point instances"<<endl;
+    cout<<argv[0]<<" 13 [num_points]: compare water density of Newton and bisection iteration"<<endl;
+    cout<<argv[0]<<" 14: check residual Helmholtz free energy of IAPWS-95 against the verification values"<<endl;
+    cout<<argv[0]<<" 15 [num_points]: check convergence of prop_pHX at random (p, T, X) points"<<endl;
+    cout<<argv[0]<<" 16 [num_points]: check prop_pHX_batch with hints of the previous time step"<<endl;
+    cout<<argv[0]<<" 17 [max_level]: compare LUT built with and without vertex cache"<<endl;
+    cout<<argv[0]<<" 18 [max_level]: compare breadth-first and recursive refinement of 3D LUT"<<endl;
+    cout<<argv[0]<<" 19 [max_level]: compare point-major and property-major layout of the LUT properties"<<endl;
+    cout<<argv[0]<<" 20 [num_points]: check the multi-property and batch interpolation kernels against bilinear_cal"<<endl;
+    cout<<argv[0]<<" 21 [max_level]: check binary, compressed and partitioned vtu files against the ASCII vtu file"<<endl;
+    cout<<argv[0]<<" 22 [max_level]: compare batch lookup with deferred EOS calculation against single point lookup"<<endl;
+    cout<<argv[0]<<" 23 [num_points]: compare the fused water state with the single property functions of cH2O"<<endl;
+    cout<<argv[0]<<" 24 [num_points]: check temperature of the V+L+H boundary by Newton iteration against bisection"<<endl;
+    cout<<argv[0]<<" 25 [num_points]: check the accelerated phase region classifier against the exact one"<<endl;
+    cout<<argv[0]<<" 26 [num_points]: check the column-oriented array version of prop_pTX and prop_pHX"<<endl;
 
     exit(0);
 }
@@ -606,6 +1795,7 @@ int main(int argc, char** argv)
     // if(argc<2)return 0;
 
     int ind = 0;
+    int num_fail = 0;
     std::string dummy;
     int test_index = atoi(argv[1]);
     switch (test_index)
@@ -653,6 +1843,77 @@ int main(int argc, char** argv)
         cout<<"Test loading 3D LUT: "<<argv[2]<<endl;
         load_binary_3d(argv[2],(bool)atoi(argv[3]));
         break;
+    case 9:
+        if(argc!=3)help(argv);
+        num_fail = compare_linear_tree_storage(atoi(argv[2]));
+        break;
+    case 10:
+        if(argc!=3)help(argv);
+        num_fail = compare_lookup_batch(atoi(argv[2]));
+        break;
+    case 11:
+        if(argc!=3)help(argv);
+        num_fail = compare_single_binary(atoi(argv[2]));
+        break;
+    case 12:
+        if(argc!=3)help(argv);
+        num_fail = compare_shared_eos(atoi(argv[2]));
+        break;
+    case 13:
+        if(argc!=3)help(argv);
+        num_fail = compare_water_density(atoi(argv[2]));
+        break;
+    case 14:
+        num_fail = check_Phi_r();
+        break;
+    case 15:
+        if(argc!=3)help(argv);
+        num_fail = check_prop_pHX(atoi(argv[2]));
+        break;
+    case 16:
+        if(argc!=3)help(argv);
+        num_fail = check_prop_pHX_hint(atoi(argv[2]));
+        break;
+    case 17:
+        if(argc!=3)help(argv);
+        num_fail = compare_vertex_cache(atoi(argv[2]));
+        break;
+    case 18:
+        if(argc!=3)help(argv);
+        num_fail = compare_refine_level(atoi(argv[2]));
+        break;
+    case 19:
+        if(argc!=3)help(argv);
+        num_fail = compare_props_layout(atoi(argv[2]));
+        break;
+    case 20:
+        if(argc!=3)help(argv);
+        num_fail = check_interp_kernel<2>(atoi(argv[2])) + check_interp_kernel<3>(atoi(argv[2]));
+        break;
+    case 21:
+        if(argc!=3)help(argv);
+        num_fail = check_vtu_writer(atoi(argv[2]));
+        break;
+    case 22:
+        if(argc!=3)help(argv);
+        num_fail = check_lookup_deferred(atoi(argv[2]));
+        break;
+    case 23:
+        if(argc!=3)help(argv);
+        num_fail = check_water_state(atoi(argv[2]));
+        break;
+    case 24:
+        if(argc!=3)help(argv);
+        num_fail = check_T_VLH(atoi(argv[2]));
+        break;
+    case 25:
+        if(argc!=3)help(argv);
+        num_fail = check_fast_region(atoi(argv[2]));
+        break;
+    case 26:
+        if(argc!=3)help(argv);
+        num_fail = check_prop_columns(atoi(argv[2]));
+        break;
     default:
         break;
     }
@@ -662,4 +1923,5 @@ int main(int argc, char** argv)
 
     std::cout << "Enter to continue..." << std::endl;
     std::getline(std::cin, dummy);
+    return num_fail;
 }
\ No newline at end of file
@@ -44,6 +44,7 @@ namespace SWEOSbash
   ,m_haveT(false), m_havet(false), m_haveX(false), m_haveH(false), m_haveR(false),m_haveO(false)
   ,m_valueD(-1), m_valueO(""),m_valueV("")
   ,m_normalize_vtk(false)
+  ,m_haveS(false), m_resume(false), m_valueS(0)
   {
     #ifndef USE_OMP
       m_threadNumOMP = 1;
@@ -87,7 +88,7 @@ namespace SWEOSbash
   {
     if(argc<2)return false; //there is no arguments
     int opt; 
-    const char *optstring = "D:V:P:T:X:H:R:O:G:t:vhn"; // set argument templete
+    const char *optstring = "D:V:P:T:X:H:R:O:G:S:t:vhnr"; // set argument templete
     int option_index = 0;
     // static struct option long_options[] = {
     //     {"version", no_argument, NULL, 'v'},
@@ -118,6 +119,19 @@ namespace SWEOSbash
       case 'n':
         m_normalize_vtk=true;
         break;
+      case 'r':
+        m_resume=true;
+        break;
+      case 'S':
+        m_haveS=true;
+        if(!GetOptionValue(opt, optarg, doubleOptValue))return false;
+        m_valueS=(int)doubleOptValue;
+        if(m_valueS<1)
+        {
+          cout<<ERROR_COUT<<"Option of -S argument must be a positive integer"<<endl;
+          return false;
+        }
+        break;
       case 'D':
         m_haveD=true;
         if(!GetOptionValue(opt, optarg, doubleOptValue))return false;
@@ -329,12 +343,12 @@ namespace SWEOSbash
           <<"\n"<<endl;
       int lenT = (int)(arrT.size());
       int lenP = (int)(arrP.size());
-      #pragma omp parallel for shared(arrT, arrP, arrX, props, lenT)
+      H2ONaCl::cH2ONaCl eos; //one instance is shared by all threads, prop_pTX/prop_pHX are reentrant
+      #pragma omp parallel for shared(arrT, arrP, arrX, props, lenT, eos)
       for (int j = 0; j < lenP; j++)
       {
         for (int k = 0; k < lenT; k++)
         {
-          H2ONaCl::cH2ONaCl eos;
           props[k+j*lenT] = eos.prop_pTX(arrP[j]*1e5, arrT[k]+Kelvin, arrX[0]);
           // props[k+j*lenT]=eos.m_prop;
         }
@@ -377,12 +391,12 @@ namespace SWEOSbash
           <<"\n"<<endl;
       int lenX=arrX.size();
       int lenP = (int)(arrP.size());
-      #pragma omp parallel for shared(arrT, arrP, arrX, props, lenX)
+      H2ONaCl::cH2ONaCl eos;
+      #pragma omp parallel for shared(arrT, arrP, arrX, props, lenX, eos)
       for (int j = 0; j < lenP; j++)
       {
         for (int k = 0; k < lenX; k++)
         {
-          H2ONaCl::cH2ONaCl eos;
           props[k+j*lenX] = eos.prop_pTX(arrP[j]*1e5, arrT[0]+Kelvin, arrX[k]);
           // =eos.m_prop;
         }
@@ -424,12 +438,12 @@ namespace SWEOSbash
           <<"\n"<<endl;
       int lenT=arrT.size();
       int lenX = (int)(arrX.size());
-      #pragma omp parallel for shared(arrT, arrP, arrX, props, lenT)
+      H2ONaCl::cH2ONaCl eos;
+      #pragma omp parallel for shared(arrT, arrP, arrX, props, lenT, eos)
       for (int j = 0; j < lenX; j++)
       {
         for (int k = 0; k < lenT; k++)
         {
-          H2ONaCl::cH2ONaCl eos;
           props[k+j*lenT] = eos.prop_pTX(arrP[0]*1e5, arrT[k]+Kelvin, arrX[j]);
           // =eos.m_prop;
         }
@@ -472,12 +486,12 @@ namespace SWEOSbash
           <<"\n"<<endl;
       int lenH=arrH.size();
       int lenP = (int)(arrP.size());
-      #pragma omp parallel for shared(arrH, arrP, arrX, props, lenH)
+      H2ONaCl::cH2ONaCl eos;
+      #pragma omp parallel for shared(arrH, arrP, arrX, props, lenH, eos)
       for (int j = 0; j < lenP; j++)
       {
         for (int k = 0; k < lenH; k++)
         {
-          H2ONaCl::cH2ONaCl eos;
           props[k+j*lenH] = eos.prop_pHX(arrP[j]*1e5, arrH[k]*1000.0, arrX[0]);
           // =eos.m_prop;
         }
@@ -520,12 +534,12 @@ namespace SWEOSbash
           <<"\n"<<endl;
       int lenH=arrH.size();
       int lenX = (int)(arrX.size());
-      #pragma omp parallel for shared(arrH, arrP, arrX, props, lenH)
+      H2ONaCl::cH2ONaCl eos;
+      #pragma omp parallel for shared(arrH, arrP, arrX, props, lenH, eos)
       for (int j = 0; j < lenX; j++)
       {
         for (int k = 0; k < lenH; k++)
         {
-          H2ONaCl::cH2ONaCl eos;
           props[k+j*lenH] = eos.prop_pHX(arrP[0]*1e5, arrH[k]*1000.0, arrX[j]);
           // =eos.m_prop;
         }
@@ -591,6 +605,213 @@ namespace SWEOSbash
     
     return true;
   }
+  // fields of the slab files, the same as writeProps2VTK
+  static const int NUM_FIELDS_SLAB = 14;
+  static const char* FIELDS_SLAB[NUM_FIELDS_SLAB] = {"PhaseRegion", "Temperature", "Rho", "H", "Xl", "Xv", "Rho_l", "Rho_v", "Rho_h", "H_l", "H_v", "H_h", "mu_l", "mu_v"};
+  static int fseek64(FILE* fp, unsigned long long pos)
+  {
+    #ifdef _WIN32
+      return _fseeki64(fp, (__int64)pos, SEEK_SET);
+    #else
+      return fseeko(fp, (off_t)pos, SEEK_SET);
+    #endif
+  }
+  bool Calculate3DSlabs(const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, 
+                        std::function<H2ONaCl::PROP_H2ONaCl(double, double, double)> prop_xyz, int num_z_slab, bool resume, 
+                        std::string outFile, std::string xTitle, std::string yTitle, std::string zTitle, bool isNormalize)
+  {
+    const size_t nx=x.size(), ny=y.size(), nz=z.size(), nxy=nx*ny, num_points=nxy*nz;
+    if(num_points==0)
+    {
+      cout<<ERROR_COUT<<"The 3D grid is empty, please check -R option"<<endl;
+      return false;
+    }
+    if(num_z_slab<1)num_z_slab=1;
+    const int num_slabs=(int)((nz+num_z_slab-1)/num_z_slab);
+    // 1. file format: .bin or .vtr
+    vector<string> tmp=string_split(outFile,".");
+    string extname=(tmp.size()>1 ? tmp[tmp.size()-1] : "");
+    if(extname!="bin" && extname!="vtr")
+    {
+      string newfilename="";
+      for (size_t i = 0; i < (tmp.size()>1 ? tmp.size()-1 : tmp.size()); i++)newfilename+=tmp[i];
+      outFile=newfilename+".vtr";
+      cout<<WARN_COUT<<"The slab mode writes .bin or .vtr files, the results are written to "<<outFile<<endl;
+    }
+    const bool isVTK=(extname!="bin");
+    // 2. file layout. 
+    // bin: "SWEOS3D" magic, uint64 nx, ny, nz, number of fields, field names (32 chars each), x, y, z, then one record of doubles per point, x is the fastest index
+    // vtr: XML header, coordinates and one array per field in the raw appended data, each slab is written to its part of every array
+    string header;
+    vector<unsigned long long> pos_fields(NUM_FIELDS_SLAB); //file position of the first value of each field in vtr file
+    vector<int> size_fields(NUM_FIELDS_SLAB, sizeof(double));
+    unsigned long long pos_end=0;
+    const std::vector<double>* coords[3]={&x, &y, &z};
+    if(isVTK)
+    {
+      size_fields[0]=sizeof(int); //PhaseRegion is Int32
+      ostringstream xml;
+      unsigned long long offset=0;
+      xml<<"<?xml version=\"1.0\"?>\n"
+         <<"<VTKFile type=\"RectilinearGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n"
+         <<"  <RectilinearGrid WholeExtent=\"0 "<<nx-1<<" 0 "<<ny-1<<" 0 "<<nz-1<<"\">\n"
+         <<"    <Piece Extent=\"0 "<<nx-1<<" 0 "<<ny-1<<" 0 "<<nz-1<<"\">\n"
+         <<"      <Coordinates>\n";
+      const string titles[3]={xTitle, yTitle, zTitle};
+      for (int d = 0; d < 3; d++)
+      {
+        xml<<"        <DataArray type=\"Float64\" Name=\""<<titles[d]<<"\" format=\"appended\" offset=\""<<offset<<"\"/>\n";
+        offset+=sizeof(unsigned long long)+coords[d]->size()*sizeof(double);
+      }
+      xml<<"      </Coordinates>\n"
+         <<"      <PointData Scalars=\"PhaseRegion\">\n";
+      vector<unsigned long long> offset_fields(NUM_FIELDS_SLAB);
+      for (int k = 0; k < NUM_FIELDS_SLAB; k++)
+      {
+        offset_fields[k]=offset;
+        xml<<"        <DataArray type=\""<<(k==0 ? "Int32" : "Float64")<<"\" Name=\""<<FIELDS_SLAB[k]<<"\" format=\"appended\" offset=\""<<offset<<"\"/>\n";
+        offset+=sizeof(unsigned long long)+num_points*size_fields[k];
+      }
+      xml<<"      </PointData>\n"
+         <<"    </Piece>\n"
+         <<"  </RectilinearGrid>\n"
+         <<"  <AppendedData encoding=\"raw\">\n"
+         <<"   _";
+      header=xml.str();
+      const unsigned long long pos_appended=header.size();
+      for (int d = 0; d < 3; d++)
+      {
+        vector<double> coord(*coords[d]);
+        double vmin=*min_element(coord.begin(), coord.end()), vmax=*max_element(coord.begin(), coord.end());
+        if(isNormalize)for (size_t i = 0; i < coord.size(); i++)coord[i]=(coord[i]-vmin)/(vmax==vmin ? 1 : vmax-vmin);
+        unsigned long long size=coord.size()*sizeof(double);
+        header.append((const char*)&size, sizeof(size));
+        header.append((const char*)coord.data(), size);
+      }
+      for (int k = 0; k < NUM_FIELDS_SLAB; k++)pos_fields[k]=pos_appended+offset_fields[k]+sizeof(unsigned long long);
+      pos_end=pos_appended+offset;
+    }else
+    {
+      unsigned long long dims[4]={nx, ny, nz, (unsigned long long)NUM_FIELDS_SLAB};
+      header.append("SWEOS3D", 8);
+      header.append((const char*)dims, sizeof(dims));
+      for (int k = 0; k < NUM_FIELDS_SLAB; k++)
+      {
+        char name[32]={0};
+        strncpy(name, FIELDS_SLAB[k], sizeof(name)-1);
+        header.append(name, sizeof(name));
+      }
+      for (int d = 0; d < 3; d++)header.append((const char*)coords[d]->data(), coords[d]->size()*sizeof(double));
+      pos_end=header.size()+num_points*NUM_FIELDS_SLAB*sizeof(double);
+    }
+    // 3. resume from the last completed slab, the resume file records the sweep and the number of completed slabs
+    string fname_resume=outFile+".resume";
+    ostringstream sweep;
+    sweep<<setprecision(17)<<outFile<<" "<<nx<<" "<<ny<<" "<<nz<<" "<<num_z_slab<<" "<<isNormalize;
+    for (int d = 0; d < 3; d++)sweep<<" "<<coords[d]->front()<<" "<<coords[d]->back();
+    int slab_begin=0;
+    if(resume)
+    {
+      ifstream fin(fname_resume);
+      string line;
+      if(fin && getline(fin, line))
+      {
+        if(line!=sweep.str())
+        {
+          cout<<ERROR_COUT<<"The sweep in resume file "<<fname_resume<<" is different from the current arguments, please use the same -V, -R, -S, -n and -O options"<<endl;
+          return false;
+        }
+        fin>>slab_begin;
+        cout<<COLOR_GREEN<<"Resume from slab "<<slab_begin<<" of "<<num_slabs<<COLOR_DEFAULT<<endl;
+      }else
+      {
+        cout<<WARN_COUT<<"There is no resume file "<<fname_resume<<", the sweep starts from the first slab"<<endl;
+      }
+    }
+    FILE* fp=fopen(outFile.c_str(), slab_begin>0 ? "r+b" : "wb");
+    if(!fp)
+    {
+      cout<<ERROR_COUT<<"Can not open file: "<<outFile<<endl;
+      return false;
+    }
+    if(slab_begin==0)
+    {
+      fwrite(header.data(), 1, header.size(), fp);
+      if(isVTK)
+      {
+        for (int k = 0; k < NUM_FIELDS_SLAB; k++)
+        {
+          unsigned long long size=num_points*size_fields[k];
+          fseek64(fp, pos_fields[k]-sizeof(size));
+          fwrite(&size, sizeof(size), 1, fp);
+        }
+      }
+    }
+    // 4. calculate and write slab by slab, the memory only depends on the slab size
+    cout<<"3D calculation in "<<num_slabs<<" slabs of "<<num_z_slab<<" "<<zTitle<<" values ("<<num_z_slab*nxy<<" points), results are written to "<<outFile<<"\n"<<endl;
+    MultiProgressBar multiBar(num_slabs-slab_begin, COLOR_BAR_BLUE);
+    vector<double> fields;
+    vector<char> buffer;
+    for (int slab = slab_begin; slab < num_slabs; slab++)
+    {
+      size_t iz_begin=(size_t)slab*num_z_slab, iz_end=min(nz, iz_begin+num_z_slab);
+      long long n=(long long)((iz_end-iz_begin)*nxy);
+      fields.resize(n*NUM_FIELDS_SLAB);
+      #pragma omp parallel for schedule(dynamic, 16) shared(fields, prop_xyz)
+      for (long long l = 0; l < n; l++)
+      {
+        size_t ind=iz_begin*nxy+l;
+        H2ONaCl::PROP_H2ONaCl prop=prop_xyz(x[ind%nx], y[(ind/nx)%ny], z[ind/nxy]);
+        double* f=&fields[l*NUM_FIELDS_SLAB];
+        f[0]=prop.Region; f[1]=prop.T; f[2]=prop.Rho; f[3]=prop.H; f[4]=prop.X_l; f[5]=prop.X_v; f[6]=prop.Rho_l; 
+        f[7]=prop.Rho_v; f[8]=prop.Rho_h; f[9]=prop.H_l; f[10]=prop.H_v; f[11]=prop.H_h; f[12]=prop.Mu_l; f[13]=prop.Mu_v;
+      }
+      if(isVTK)
+      {
+        for (int k = 0; k < NUM_FIELDS_SLAB; k++)
+        {
+          buffer.resize(n*size_fields[k]);
+          for (long long l = 0; l < n; l++)
+          {
+            if(k==0)
+            {
+              int region=(int)fields[l*NUM_FIELDS_SLAB];
+              memcpy(&buffer[l*sizeof(int)], &region, sizeof(int));
+            }else
+            {
+              memcpy(&buffer[l*sizeof(double)], &fields[l*NUM_FIELDS_SLAB+k], sizeof(double));
+            }
+          }
+          fseek64(fp, pos_fields[k]+iz_begin*nxy*size_fields[k]);
+          fwrite(buffer.data(), 1, buffer.size(), fp);
+        }
+      }else
+      {
+        fseek64(fp, header.size()+iz_begin*nxy*NUM_FIELDS_SLAB*sizeof(double));
+        fwrite(fields.data(), sizeof(double), fields.size(), fp);
+      }
+      // the slab is only recorded as completed after it is flushed
+      if(fflush(fp)!=0)
+      {
+        cout<<ERROR_COUT<<"Write file failed: "<<outFile<<endl;
+        fclose(fp);
+        return false;
+      }
+      ofstream fout_resume(fname_resume);
+      fout_resume<<sweep.str()<<"\n"<<slab+1<<endl;
+      fout_resume.close();
+      multiBar.Update();
+    }
+    if(isVTK)
+    {
+      fseek64(fp, pos_end);
+      fprintf(fp, "\n  </AppendedData>\n</VTKFile>\n");
+    }
+    fclose(fp);
+    remove(fname_resume.c_str());
+    cout<<COLOR_BLUE<<"Results have been saved to file: "<<COLOR_DEFAULT<<outFile<<endl;
+    return true;
+  }
   bool cSWEOSarg::Validate_3D()
   {
     if(m_valueV.size()!=3)
@@ -658,9 +879,6 @@ namespace SWEOSbash
       vector<double> arrP= linspace(m_valueR[indP][0], m_valueR[indP][2], m_valueR[indP][1]);
       vector<double> arrX= linspace(m_valueR[indX][0], m_valueR[indX][2], m_valueR[indX][1]);
       vector<H2ONaCl::PROP_H2ONaCl> props;
-      props.resize(arrT.size()*arrP.size()*arrX.size());
-      //progressbar
-      MultiProgressBar multiBar(arrP.size(),COLOR_BAR_BLUE);
       #ifndef USE_OMP
       #else
         omp_set_num_threads(m_threadNumOMP);
@@ -674,14 +892,22 @@ namespace SWEOSbash
       int lenTX=arrT.size()*arrX.size();
       int lenX = (int)(arrX.size());
       int lenP = (int)(arrP.size());
-      #pragma omp parallel for shared(arrT, arrP, arrX, props, lenT, lenTX)
+      H2ONaCl::cH2ONaCl eos;
+      if(m_haveS)
+      {
+        return Calculate3DSlabs(arrX, arrT, arrP, [&eos](double X, double T, double P){ return eos.prop_pTX(P*1e5, T+Kelvin, X); }, 
+                                m_valueS, m_resume, m_valueO, "Salinity", "Temperature (deg.C)", "Pressure (bar)", m_normalize_vtk);
+      }
+      props.resize(arrT.size()*arrP.size()*arrX.size());
+      //progressbar
+      MultiProgressBar multiBar(arrP.size(),COLOR_BAR_BLUE);
+      #pragma omp parallel for shared(arrT, arrP, arrX, props, lenT, lenTX, eos)
       for (int i = 0; i < lenP; i++)
       {
         for (int j = 0; j < lenT; j++)
         {
           for (int k = 0; k < lenX; k++)
           {
-            H2ONaCl::cH2ONaCl eos;
             props[k+j*lenX+i*lenTX]=eos.prop_pTX(arrP[i]*1e5, arrT[j]+Kelvin, arrX[k]);
           }
         }
@@ -720,9 +946,6 @@ namespace SWEOSbash
       vector<double> arrP= linspace(m_valueR[indP][0], m_valueR[indP][2], m_valueR[indP][1]);
       vector<double> arrX= linspace(m_valueR[indX][0], m_valueR[indX][2], m_valueR[indX][1]);
       vector<H2ONaCl::PROP_H2ONaCl> props;
-      props.resize(arrH.size()*arrP.size()*arrX.size());
-      //progressbar
-      MultiProgressBar multiBar(arrP.size(),COLOR_BAR_BLUE);
       #ifndef USE_OMP
       #else
         omp_set_num_threads(m_threadNumOMP);
@@ -737,6 +960,14 @@ namespace SWEOSbash
       int lenX = (int)(arrX.size());
       int lenP = (int)(arrP.size());
       H2ONaCl::cH2ONaCl eos;
+      if(m_haveS)
+      {
+        return Calculate3DSlabs(arrX, arrH, arrP, [&eos](double X, double H, double P){ return eos.prop_pHX(P*1e5, H*1000.0, X); }, 
+                                m_valueS, m_resume, m_valueO, "Salinity", "Enthalpy (kJ/kg)", "Pressure (bar)", m_normalize_vtk);
+      }
+      props.resize(arrH.size()*arrP.size()*arrX.size());
+      //progressbar
+      MultiProgressBar multiBar(arrP.size(),COLOR_BAR_BLUE);
       #pragma omp parallel for shared(arrH, arrP, arrX, lenH, lenHX, eos)
       for (int i = 0; i < lenP; i++)
       {
@@ -995,7 +1226,7 @@ namespace SWEOSbash
       {
         cout<<WARN_COUT<<"You specify a input file for multi-points calculation\n"
         <<"Please make sure your input file with 3 columns in order of "<<m_valueV<<endl;
-        calculateMultiPoints_PTX_PHX(m_valueV,m_valueG, m_valueO,"T");
+        calculateMultiPoints_PTX_PHX(m_valueV,m_valueG, m_valueO,"T", m_threadNumOMP);
       }else
       {
         cout<<ERROR_COUT<<"There neither full -T, -P, -X options nor -G argument, swEOS will exit"<<endl;
@@ -1036,7 +1267,7 @@ namespace SWEOSbash
         {
           cout<<WARN_COUT<<"You specify a input file for multi-points calculation\n"
           <<COLOR_PURPLE<<"\tPlease make sure your input file with 3 columns in order of "<<COLOR_RED<<m_valueV<<COLOR_DEFAULT<<endl;
-          calculateMultiPoints_PTX_PHX(m_valueV,m_valueG, m_valueO,"H");
+          calculateMultiPoints_PTX_PHX(m_valueV,m_valueG, m_valueO,"H", m_threadNumOMP);
         }
         else
         {
@@ -1351,104 +1582,180 @@ namespace SWEOSbash
     }
     return eos.m_prop;
   }
-  vector<H2ONaCl::PROP_H2ONaCl> calculateMultiPoints_PTX_PHX(string valueV, string filePTX, string outFile, string isT_H)
+  /**
+   * @brief Buffered reader of the -G file, a text file with 3 columns or a binary file (*.bin) with 3 doubles per point.
+   * 
+   */
+  class PointsReader
   {
-    ifstream fin(filePTX);
-    if(!fin)
-    {
-      cout<<ERROR_COUT<<"Open file failed, please check -G argument, the file name specified by -G is "<<COLOR_RED<<filePTX<<COLOR_DEFAULT<<endl;
-      exit(0);
-    }
-    vector<double>P, T_H, X;
-    double p,t,x;
-    if(valueV=="P"+isT_H+"X")
-    {
-      while (!fin.eof())
-      {
-        fin>>p>>t>>x;
-        P.push_back(p);
-        T_H.push_back(t);
-        X.push_back(x);
+  private:
+    FILE* m_fp;
+    bool m_binary, m_eof;
+    vector<char> m_buffer; //text in [m_begin, m_end), followed by '\0'
+    size_t m_begin, m_end, m_line;
+    unsigned long long m_bytes_read;
+  public:
+    PointsReader(string filename)
+    :m_fp(NULL), m_eof(false), m_buffer(1<<22), m_begin(0), m_end(0), m_line(0), m_bytes_read(0)
+    {
+      m_binary=(filename.size()>4 && filename.substr(filename.size()-4)==".bin");
+      m_fp=fopen(filename.c_str(), m_binary ? "rb" : "r");
+    }
+    ~PointsReader(){if(m_fp)fclose(m_fp);}
+    bool is_open(){return m_fp!=NULL;}
+    unsigned long long bytes_read(){return m_bytes_read;}
+    /**
+     * @brief Read at most max_rows points to rows (3 values per point, in the order of the file), return the number of points read, 0 at the end of the file.
+     * 
+     */
+    size_t read(size_t max_rows, vector<double>& rows)
+    {
+      rows.resize(max_rows*3);
+      if(m_binary)
+      {
+        size_t n=fread(rows.data(), sizeof(double)*3, max_rows, m_fp);
+        m_bytes_read+=n*sizeof(double)*3;
+        return n;
       }
-    }else if(valueV=="PX"+isT_H+"")
-    {
-      while (!fin.eof())
+      size_t n=0;
+      while (n<max_rows)
       {
-        fin>>p>>x>>t;
-        P.push_back(p);
-        T_H.push_back(t);
-        X.push_back(x);
+        char* line=m_buffer.data()+m_begin;
+        char* line_end=(char*)memchr(line, '\n', m_end-m_begin);
+        if(!line_end)
+        {
+          if(m_eof)
+          {
+            if(m_begin==m_end)break;
+            line_end=m_buffer.data()+m_end; //last line without line break
+          }else
+          {
+            // move the incomplete line to the front and fill the buffer
+            memmove(m_buffer.data(), line, m_end-m_begin);
+            m_end-=m_begin;
+            m_begin=0;
+            if(m_end+1>=m_buffer.size())m_buffer.resize(m_buffer.size()*2);
+            size_t len=fread(m_buffer.data()+m_end, 1, m_buffer.size()-1-m_end, m_fp);
+            m_eof=(len==0);
+            m_end+=len;
+            m_buffer[m_end]='\0';
+            continue;
+          }
+        }
+        m_line++;
+        *line_end='\0';
+        m_begin=min(m_end, (size_t)(line_end-m_buffer.data())+1);
+        m_bytes_read+=line_end-line+1;
+        char* p=line;
+        char* p_end=NULL;
+        int i=0;
+        for (; i < 3; i++, p=p_end)
+        {
+          rows[n*3+i]=strtod(p, &p_end);
+          if(p_end==p)break;
+        }
+        if(i==0 && strspn(line, " \t\r,")==strlen(line))continue; //empty line
+        if(i<3)
+        {
+          cout<<ERROR_COUT<<"The line "<<m_line<<" of the -G file must have 3 columns, but it is: "<<COLOR_RED<<line<<COLOR_DEFAULT<<endl;
+          exit(0);
+        }
+        n++;
       }
-    }else if(valueV==""+isT_H+"PX")
+      return n;
+    }
+  };
+  bool calculateMultiPoints_PTX_PHX(string valueV, string filePTX, string outFile, string isT_H, int threadNumOMP)
+  {
+    // column of P, T or H, X in the -G file
+    size_t colP=valueV.find('P'), colTH=valueV.find(isT_H), colX=valueV.find('X');
+    if(valueV.size()!=3 || colP==string::npos || colTH==string::npos || colX==string::npos)
     {
-      while (!fin.eof())
-      {
-        fin>>t>>p>>x;
-        P.push_back(p);
-        T_H.push_back(t);
-        X.push_back(x);
-      }
-    }else if(valueV==""+isT_H+"XP")
+      cout<<ERROR_COUT<<"The -V argument must be one of P"+isT_H+"X, PX"+isT_H+
+                        ", "+isT_H+"PX, "+isT_H+"XP, XP"+isT_H+", X"+isT_H+"P when -D0\n"
+      <<"The -V option you set is "<<COLOR_RED<<valueV<<COLOR_DEFAULT<<" which is not supported"<<endl;
+      exit(0);
+    }
+    PointsReader reader(filePTX);
+    if(!reader.is_open())
     {
-      while (!fin.eof())
-      {
-        fin>>t>>x>>p;
-        P.push_back(p);
-        T_H.push_back(t);
-        X.push_back(x);
-      }
-    }else if(valueV=="XP"+isT_H+"")
+      cout<<ERROR_COUT<<"Open file failed, please check -G argument, the file name specified by -G is "<<COLOR_RED<<filePTX<<COLOR_DEFAULT<<endl;
+      exit(0);
+    }
+    if(outFile=="")
     {
-      while (!fin.eof())
-      {
-        fin>>x>>p>>t;
-        P.push_back(p);
-        T_H.push_back(t);
-        X.push_back(x);
-      }
-    }else if(valueV=="X"+isT_H+"P")
+      cout<<WARN_COUT<<"The output file has to be specified by -O argument"<<outFile<<endl;
+      exit(0);
+    }
+    vector<string> tmp=string_split(outFile,".");
+    if(tmp.size()<1 || tmp[tmp.size()-1]!="csv")
     {
-      while (!fin.eof())
-      {
-        fin>>x>>t>>p;
-        P.push_back(p);
-        T_H.push_back(t);
-        X.push_back(x);
-      }
-    }else
+      cout<<WARN_COUT<<"Unrecognized format: "<<outFile<<endl;
+      cout<<COLOR_GREEN<<"Write results into csv file format"<<COLOR_DEFAULT<<endl;
+    }
+    FILE* fpout=fopen(outFile.c_str(), "w");
+    if(!fpout)
     {
-      cout<<ERROR_COUT<<"The -V argument must be one of P"+isT_H+"X, PX"+isT_H+
-                        ", "+isT_H+"PX, "+isT_H+"XP, XP"+isT_H+", X"+isT_H+"P when -D0\n"
-      <<"The -V option you set is "<<COLOR_RED<<valueV<<COLOR_DEFAULT<<" which is not supported"<<endl;
+      cout<<WARN_COUT<<"The output file name is specified by -O argument, but open file failed: "<<outFile<<endl;
       exit(0);
     }
-    fin.close();
-
-    //calculate
+    fprintf(fpout, "T(C), P(bar), X, Phase Index, Phase Region, "
+                   "Bulk density(kg/m3), Liquid density(kg/m3), Vapour density(kg/m3), Halite density(kg/m3), "
+                   "Bulk enthalpy(kJ/kg), Liquid enthalpy(kJ/kg), Vapour enthalpy(kJ/kg), Halite enthalpy(kJ/kg), "
+                   "Liquid Saturation, Vapour Saturation, Halite Saturation, "
+                   "Liquid viscosity, Vapour viscosity, "
+                   "Liquid salinity, Vapour salinity\n");
+    #ifndef USE_OMP
+    #else
+      omp_set_num_threads(threadNumOMP);
+    #endif
+    // read, calculate and write chunk by chunk, the lines of a chunk are formatted in parallel and written in order
+    struct stat st;
+    double file_size=(stat(filePTX.c_str(), &st)==0 && st.st_size>0) ? (double)st.st_size : 1;
+    MultiProgressBar multibar(file_size,COLOR_BAR_BLUE);
     H2ONaCl::cH2ONaCl eos;
-    vector<H2ONaCl::PROP_H2ONaCl> props;
-    MultiProgressBar multibar(P.size(),COLOR_BAR_BLUE);
-    if(isT_H=="T")
-    {
-      for(int i=0;i<P.size();i++)
-      {
-        eos.m_prop=eos.prop_pTX(P[i]*1e5, T_H[i]+Kelvin, X[i]);
-        props.push_back(eos.m_prop);
-        multibar.Update();
+    const size_t size_chunk=1<<16;
+    const int size_block=1024;
+    vector<double> rows;
+    vector<H2ONaCl::PROP_H2ONaCl> props(size_chunk);
+    vector<string> text_blocks((size_chunk+size_block-1)/size_block);
+    size_t num_points=0;
+    for (size_t n=reader.read(size_chunk, rows); n>0; n=reader.read(size_chunk, rows))
+    {
+      #pragma omp parallel for schedule(dynamic, 16) shared(rows, props, eos)
+      for (long long i = 0; i < (long long)n; i++)
+      {
+        const double* row=&rows[i*3];
+        if(isT_H=="T")props[i]=eos.prop_pTX(row[colP]*1e5, row[colTH]+Kelvin, row[colX]);
+        else props[i]=eos.prop_pHX(row[colP]*1e5, row[colTH]*1000, row[colX]);
       }
-    }else if(isT_H=="H")
-    {
-      for(int i=0;i<P.size();i++)
-      {
-        eos.m_prop=eos.prop_pHX(P[i]*1e5, T_H[i]*1000, X[i]);
-        props.push_back(eos.m_prop);
-        multibar.Update();
+      int num_blocks=(int)((n+size_block-1)/size_block);
+      const H2ONaCl::MAP_PHASE_REGION& names_region=eos.m_phaseRegion_name;
+      #pragma omp parallel for schedule(dynamic) shared(rows, props, names_region, text_blocks)
+      for (int b = 0; b < num_blocks; b++)
+      {
+        string& text=text_blocks[b];
+        char str[1024];
+        text.clear();
+        for (size_t i = b*size_block; i < min(n, (size_t)(b+1)*size_block); i++)
+        {
+          const H2ONaCl::PROP_H2ONaCl& prop=props[i];
+          // the same format as WriteCSV
+          int len=snprintf(str, sizeof(str), "%g, %g, %g, %d, %s, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g\n",
+                           prop.T, rows[i*3+colP], rows[i*3+colX], (int)prop.Region, names_region.at(prop.Region).c_str(),
+                           prop.Rho, prop.Rho_l, prop.Rho_v, prop.Rho_h, 
+                           prop.H/1000.0, prop.H_l/1000.0, prop.H_v/1000.0, prop.H_h/1000.0, 
+                           prop.S_l, prop.S_v, prop.S_h, prop.Mu_l, prop.Mu_v, prop.X_l, prop.X_v);
+          text.append(str, min(len, (int)sizeof(str)-1));
+        }
       }
+      for (int b = 0; b < num_blocks; b++)fwrite(text_blocks[b].data(), 1, text_blocks[b].size(), fpout);
+      num_points+=n;
+      multibar.Update((double)reader.bytes_read());
     }
-    //write to file
-    Write1Dresult(outFile,P,X,props);
-
-    return props;
+    fclose(fpout);
+    cout<<COLOR_BLUE<<num_points<<" points are calculated, results have been saved to file: "<<outFile<<COLOR_DEFAULT<<endl;
+    return true;
   }
   bool Write1Dresult(string outFile,vector<double> P, vector<double> X, vector<H2ONaCl::PROP_H2ONaCl> props)
   {
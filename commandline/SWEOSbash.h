@@ -7,6 +7,7 @@
 #include <fstream>
 #include <iomanip>
 #include <vector>
+#include <functional>
 using namespace std;
 
 #include "H2ONaCl.H"
@@ -91,6 +92,8 @@ namespace SWEOSbash
         string m_valueV, m_valueG, m_valueO;
         double m_valueT, m_valueP, m_valueX, m_valueH;
         bool m_normalize_vtk;
+        bool m_haveS, m_resume; //slab mode of -D3 and resume it
+        int m_valueS; //number of pressure values of each slab
         // min/delta/max, order coresponding to -V parameter, 
         //e.g. -VPT, m_valueR1 for pressure, m_valueR2 for temperature
         // double m_valueR1[3], m_valueR2[3], m_valueR3[3];
@@ -131,11 +134,20 @@ namespace SWEOSbash
     H2ONaCl::PROP_H2ONaCl calculateSinglePoint_PTX(double P, double T_K, double X, bool isCout=true);
     H2ONaCl::PROP_H2ONaCl calculateSinglePoint_PHX(double P, double H, double X, bool isCout=true);
     // bool calculateMultiPoints_PHX(string valueV, string filePHX, string outFile);
-    vector<H2ONaCl::PROP_H2ONaCl> calculateMultiPoints_PTX_PHX(string valueV, string filePTX, string outFile, string isT_H);
+    bool calculateMultiPoints_PTX_PHX(string valueV, string filePTX, string outFile, string isT_H, int threadNumOMP=1);
     bool WriteCSV(string outFile,vector<double> P, vector<double> X, vector<H2ONaCl::PROP_H2ONaCl> props);
     bool Write1Dresult(string outFile,vector<double> P, vector<double> X, vector<H2ONaCl::PROP_H2ONaCl> props);
     bool Write2D3DResult(std::vector<double> x, std::vector<double> y, std::vector<double> z, std::vector<H2ONaCl::PROP_H2ONaCl> props, 
                         std::string outFile, std::string xTitle, std::string yTitle, std::string zTitle, bool isNormalize=true);
+    /**
+     * @brief Calculate a 3D grid slab by slab, a slab is num_z_slab values of z (the slowest index), and write each slab to the .bin or .vtr file once it is completed,
+     * so the memory is bounded by the slab size. An interrupted sweep can be continued from the last completed slab with resume=true.
+     * 
+     * @param prop_xyz Properties at a grid point (x, y, z)
+     */
+    bool Calculate3DSlabs(const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, 
+                        std::function<H2ONaCl::PROP_H2ONaCl(double, double, double)> prop_xyz, int num_z_slab, bool resume, 
+                        std::string outFile, std::string xTitle, std::string yTitle, std::string zTitle, bool isNormalize=true);
     static void StartText()
     {
         //30: black  31:red  32:green  33:yellow  34:blue  35:purple  36:darkgreen
@@ -197,9 +209,13 @@ namespace SWEOSbash
         cout<<setw(wordWidth)<<setiosflags(ios::left)<<"  -G "<<COLOR_BLUE<<"Set input filename of PTX or PHX text file for multi-points calculation"<<COLOR_DEFAULT<<std::endl;;
         cout<<setw(wordWidth)<<setiosflags(ios::left)<<"     "<<COLOR_DEFAULT<<"only used when -V0 and no -P, -X, -T or -H arguments."<<COLOR_DEFAULT<<std::endl;;
         cout<<setw(wordWidth)<<setiosflags(ios::left)<<"     "<<COLOR_DEFAULT<<"The text file with three columns, PTX or PHX are decided by -V options."<<COLOR_DEFAULT<<std::endl;;
+        cout<<setw(wordWidth)<<setiosflags(ios::left)<<"     "<<COLOR_DEFAULT<<"Or a binary file (*.bin) with three doubles per point in the same order. Points are calculated in parallel (-t)."<<COLOR_DEFAULT<<std::endl;;
         cout<<setw(wordWidth)<<setiosflags(ios::left)<<"  -O "<<COLOR_BLUE<<"Set out put file name, file format is determined by file extension name."<<COLOR_DEFAULT<<std::endl;;
         cout<<setw(wordWidth)<<setiosflags(ios::left)<<"     "<<COLOR_DEFAULT<<"Supported file format is vtk, csv, txt."<<COLOR_DEFAULT<<std::endl;;
         cout<<setw(wordWidth)<<setiosflags(ios::left)<<"  -n "<<COLOR_BLUE<<"If normalize the result in vtk file. Only valid when -D 3"<<COLOR_DEFAULT<<std::endl;;
+        cout<<setw(wordWidth)<<setiosflags(ios::left)<<"  -S "<<COLOR_BLUE<<"Only for -D3: calculate the grid in slabs of this number of pressure values and write each slab once it is done."<<COLOR_DEFAULT<<std::endl;;
+        cout<<setw(wordWidth)<<setiosflags(ios::left)<<"     "<<COLOR_DEFAULT<<"Supported file format is bin, vtr (VTK XML with binary data). e.g.: -S10 -OPTX.vtr"<<COLOR_DEFAULT<<std::endl;;
+        cout<<setw(wordWidth)<<setiosflags(ios::left)<<"  -r "<<COLOR_BLUE<<"Resume an interrupted -S calculation from the last completed slab."<<COLOR_DEFAULT<<std::endl;;
         cout<<setw(wordWidth)<<setiosflags(ios::left)<<"  -t "<<COLOR_BLUE<<"Set number of thread for parallel computing."<<COLOR_DEFAULT<<std::endl;;
         cout<<"Units:"<<std::endl;;
         cout<<setw(wordWidth)<<setiosflags(ios::left)<<"  Temperature "<<COLOR_BLUE<<"Degree Celsius: 273.15 deg.C = 1 K (Kelvin)"<<COLOR_DEFAULT<<std::endl;;